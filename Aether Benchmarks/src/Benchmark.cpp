@@ -0,0 +1,77 @@
+#include "Benchmark.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+void BenchmarkSuite::Run(const std::string& name, size_t entity_count, const std::function<void()>& setup, const std::function<void()>& body) {
+	Result result = { name, entity_count, m_repetitions, 0.0, 0.0, 0.0 };
+
+	double total = 0.0;
+
+	for (size_t i = 0; i < m_repetitions; i++) {
+		setup();
+
+		auto start = std::chrono::steady_clock::now();
+		body();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		result.min_ms = (i == 0) ? ms : std::min(result.min_ms, ms);
+		result.max_ms = std::max(result.max_ms, ms);
+		total += ms;
+	}
+
+	result.mean_ms = total / m_repetitions;
+	m_results.push_back(result);
+
+	// progress goes to stderr, so that stdout can be redirected to a file
+	std::cerr << std::left << std::setw(32) << name << std::right << std::setw(10) << entity_count << std::setw(12) << std::fixed << std::setprecision(3) << result.min_ms << " ms\n";
+}
+
+static std::string EscapeJson(const std::string& text) {
+	std::string escaped;
+
+	for (char c : text) {
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+
+		if (static_cast<unsigned char>(c) >= 0x20)
+			escaped += c;
+	}
+
+	return escaped;
+}
+
+void BenchmarkSuite::WriteJson(std::ostream& stream, const std::string& label) const {
+	stream << std::setprecision(6) << std::fixed;
+
+	stream << "{\n";
+	stream << "\t\"label\": \"" << EscapeJson(label) << "\",\n";
+#ifdef NDEBUG
+	stream << "\t\"build\": \"release\",\n";
+#else
+	stream << "\t\"build\": \"debug\",\n";
+#endif
+	stream << "\t\"results\": [\n";
+
+	for (size_t i = 0; i < m_results.size(); i++) {
+		const Result& result = m_results[i];
+
+		// per entity cost, based on the fastest repetition
+		double ns_per_entity = (result.entity_count > 0) ? (result.min_ms * 1e6 / result.entity_count) : 0.0;
+
+		stream << "\t\t{ "
+			<< "\"name\": \"" << EscapeJson(result.name) << "\", "
+			<< "\"entities\": " << result.entity_count << ", "
+			<< "\"repetitions\": " << result.repetitions << ", "
+			<< "\"min_ms\": " << result.min_ms << ", "
+			<< "\"mean_ms\": " << result.mean_ms << ", "
+			<< "\"max_ms\": " << result.max_ms << ", "
+			<< "\"ns_per_entity\": " << ns_per_entity
+			<< " }" << (i + 1 < m_results.size() ? "," : "") << '\n';
+	}
+
+	stream << "\t]\n";
+	stream << "}\n";
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+// Runs benchmark cases and writes their results as JSON.
+// Every case is repeated, 'setup' prepares the state before each repetition and is not measured.
+class BenchmarkSuite {
+public:
+	struct Result {
+		std::string name;
+		size_t entity_count;
+		size_t repetitions;
+		double min_ms;
+		double mean_ms;
+		double max_ms;
+	};
+
+	explicit BenchmarkSuite(size_t repetitions) : m_repetitions(repetitions) {}
+
+	void Run(const std::string& name, size_t entity_count, const std::function<void()>& setup, const std::function<void()>& body);
+
+	void WriteJson(std::ostream& stream, const std::string& label) const;
+
+private:
+	size_t m_repetitions;
+	std::vector<Result> m_results;
+};
@@ -0,0 +1,355 @@
+#include <Aether.hpp>
+#include "Benchmark.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <sstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+// Headless benchmarks of EntityManager, no window nor GL context is created.
+//
+// Usage: AetherBenchmarks [--sizes 1000,100000,1000000] [--repetitions 5] [--label name] [--output results.json]
+// JSON results are written to stdout unless an output file is given, progress is written to stderr.
+
+struct Position : public ae::Component {
+	struct SnapshotData { float x, y; };
+
+	float x = 0.f, y = 0.f;
+
+	Position() = default;
+	Position(const SnapshotData& data) : x(data.x), y(data.y) {}
+	SnapshotData GetSnapshotData() const { return { x, y }; }
+};
+struct Velocity : public ae::Component {
+	struct SnapshotData { float x, y; };
+
+	float x = 1.f, y = 0.5f;
+
+	Velocity() = default;
+	Velocity(const SnapshotData& data) : x(data.x), y(data.y) {}
+	SnapshotData GetSnapshotData() const { return { x, y }; }
+};
+struct Depth : public ae::Component {
+	float value;
+	Depth(float value) : value(value) {}
+};
+struct Bounds : public ae::Component {
+	ae::FloatRect rect;
+	Bounds(const ae::FloatRect& rect) : rect(rect) {}
+};
+
+static std::mt19937 random_engine(2021);
+
+static void ResetEntityManager() {
+	ae::EntityManager.UnregisterAllAdvancedViews();
+	ae::EntityManager.Clear();
+	ae::EntityManager.Refresh();
+}
+
+// every other entity gets Velocity and belongs to 'group'
+static void CreateEntities(size_t count, ae::EntityGroup group) {
+	for (size_t i = 0; i < count; i++) {
+		ae::Entity& entity = ae::EntityManager.CreateEntity();
+		entity.AddComponent<Position>();
+
+		if (i % 2 == 0) {
+			entity.AddComponent<Velocity>();
+			entity.AddToGroup(group);
+		}
+	}
+	ae::EntityManager.Refresh();
+}
+
+static void ShuffleDepths() {
+	std::uniform_real_distribution<float> distribution(0.f, 1000.f);
+	ae::EntityManager.ViewComponents<Depth>([&distribution](Depth& depth) { depth.value = distribution(random_engine); });
+}
+
+static void RunEntityManagerBenchmarks(BenchmarkSuite& suite, size_t count) {
+	const ae::EntityGroup group = ae::EntityManager.CreateGroup();
+
+	// creation & removal
+	suite.Run("create_entities", count, ResetEntityManager, [count]() {
+		for (size_t i = 0; i < count; i++)
+			ae::EntityManager.CreateEntity().AddComponent<Position>();
+	});
+
+	suite.Run("remove_entities", count, [count, group]() { ResetEntityManager(); CreateEntities(count, group); }, []() {
+		ae::EntityManager.Clear();
+		ae::EntityManager.Refresh();
+	});
+
+	suite.Run("churn_10_ticks_10_percent", count, [count, group]() { ResetEntityManager(); CreateEntities(count, group); }, [count]() {
+		for (size_t tick = 0; tick < 10; tick++) {
+			size_t index = 0;
+			ae::EntityManager.ViewEntities([&index, tick](ae::Entity& entity) {
+				if (index++ % 10 == tick)
+					entity.Kill();
+			});
+
+			for (size_t i = 0; i < count / 10; i++)
+				ae::EntityManager.CreateEntity().AddComponent<Position>();
+
+			ae::EntityManager.Refresh();
+		}
+	});
+
+	suite.Run("refresh_after_killing_half", count, [count, group]() {
+		ResetEntityManager();
+		CreateEntities(count, group);
+
+		size_t index = 0;
+		ae::EntityManager.ViewEntities([&index](ae::Entity& entity) {
+			if (index++ % 2 == 0)
+				entity.Kill();
+		});
+	}, []() {
+		ae::EntityManager.Refresh();
+	});
+
+	// components
+	suite.Run("add_component", count, [count, group]() { ResetEntityManager(); CreateEntities(count, group); }, []() {
+		ae::EntityManager.ViewEntities([](ae::Entity& entity) { entity.AddComponent<Depth>(0.f); });
+	});
+
+	suite.Run("remove_component", count, [count, group]() {
+		ResetEntityManager();
+		CreateEntities(count, group);
+		ae::EntityManager.ViewEntities([](ae::Entity& entity) { entity.AddComponent<Depth>(0.f); });
+	}, []() {
+		ae::EntityManager.ViewEntities([](ae::Entity& entity) { entity.RemoveComponent<Depth>(); });
+	});
+
+	// iteration
+	ResetEntityManager();
+	CreateEntities(count, group);
+	ae::EntityManager.RegisterAdvancedView(ae::ComponentPack<Position, Velocity>());
+
+	suite.Run("view_components", count, []() {}, []() {
+		ae::EntityManager.ViewComponents<Position>([](Position& position) { position.x += 1.f; });
+	});
+
+	suite.Run("view_entities_group", count, []() {}, [group]() {
+		ae::EntityManager.ViewEntities([](ae::Entity& entity) { entity.GetComponent<Position>().x += 1.f; }, group);
+	});
+
+	suite.Run("view_entities_component_pack", count, []() {}, []() {
+		ae::EntityManager.ViewEntities([](ae::Entity& entity) {
+			entity.GetComponent<Position>().x += entity.GetComponent<Velocity>().x;
+		}, ae::ComponentPack<Position, Velocity>());
+	});
+
+	suite.Run("query_each", count, []() {}, []() {
+		ae::EntityManager.Query<Position, const Velocity>().Each([](Position& position, const Velocity& velocity) {
+			position.x += velocity.x;
+			position.y += velocity.y;
+		});
+	});
+
+	// advanced views
+	suite.Run("register_advanced_view", count, []() { ae::EntityManager.UnregisterAdvancedView(ae::ComponentPack<Position, Velocity>()); }, []() {
+		ae::EntityManager.RegisterAdvancedView(ae::ComponentPack<Position, Velocity>());
+	});
+
+	suite.Run("register_advanced_group_view", count, [group]() { ae::EntityManager.UnregisterAdvancedView({ group }, { ae::EntityGroup(group + 1) }); }, [group]() {
+		ae::EntityManager.RegisterAdvancedView({ group }, { ae::EntityGroup(group + 1) });
+	});
+
+	// sorting
+	ae::EntityManager.ViewEntities([](ae::Entity& entity) { entity.AddComponent<Depth>(0.f); });
+
+	suite.Run("sort_view", count, ShuffleDepths, []() {
+		ae::EntityManager.SortView<Depth>([](Depth& left, Depth& right) { return left.value < right.value; });
+	});
+
+	suite.Run("sort_view_by_key", count, ShuffleDepths, []() {
+		ae::EntityManager.SortViewByKey<Depth>([](const Depth& depth) { return depth.value; });
+	});
+
+	suite.Run("sort_view_by_key_sorted", count, []() {}, []() {
+		ae::EntityManager.SortViewByKey<Depth>([](const Depth& depth) { return depth.value; });
+	});
+
+	// statistics, memory of the result is reused as when graphing them every tick
+	ae::EntityManagerStats stats;
+
+	suite.Run("get_stats_1000_times", count, []() {}, [&stats]() {
+		for (size_t i = 0; i < 1000; i++)
+			ae::EntityManager.GetStats(stats);
+	});
+}
+
+static void RunSpatialBenchmarks(BenchmarkSuite& suite, size_t count) {
+	ResetEntityManager();
+
+	// entities spread over a square, about 4 of them per cell
+	const float side = std::sqrt(static_cast<float>(count)) * 32.f;
+	std::uniform_real_distribution<float> distribution(0.f, side);
+
+	for (size_t i = 0; i < count; i++)
+		ae::EntityManager.CreateEntity().AddComponent<Bounds>(ae::FloatRect(distribution(random_engine), distribution(random_engine), 8.f, 8.f));
+
+	ae::EntityManager.Refresh();
+
+	ae::SpatialIndex<Bounds> index(64.f, [](const Bounds& bounds) { return bounds.rect; });
+	index.Update();
+
+	suite.Run("spatial_index_move_all", count, []() {}, [&index]() {
+		ae::EntityManager.Query<Bounds>().Each([](ae::Entity& entity, Bounds& bounds) {
+			bounds.rect.left += 3.f;
+			bounds.rect.top -= 2.f;
+			entity.MarkChanged<Bounds>();
+		});
+
+		ae::EntityManager.Refresh();
+		index.Update();
+	});
+
+	std::vector<ae::EntityId> found;
+
+	suite.Run("spatial_index_1000_radius_queries", count, []() {}, [&index, &found, &distribution]() {
+		for (size_t i = 0; i < 1000; i++) {
+			found.clear();
+			index.QueryRadius(ae::Vector2f(distribution(random_engine), distribution(random_engine)), 100.f, found);
+		}
+	});
+}
+
+static void RunTransformBenchmarks(BenchmarkSuite& suite, size_t count) {
+	ResetEntityManager();
+
+	// a forest of small trees, every node but roots has one of the preceding nodes of its tree as the parent
+	ae::TransformHierarchy hierarchy;
+	std::vector<ae::TransformComponent*> transforms;
+	transforms.reserve(count);
+
+	for (size_t i = 0; i < count; i++) {
+		const size_t tree_node = i % 16;
+		ae::EntityId parent = (tree_node == 0) ? ae::InvalidEntityId : transforms[i - 1 - random_engine() % tree_node]->GetEntity()->GetId();
+
+		ae::TransformComponent& transform = ae::EntityManager.CreateEntity().AddComponent<ae::TransformComponent>(hierarchy, parent);
+		transform.ModifyLocal().SetPosition(ae::Vector2f(1.f, 2.f)).SetRotation(static_cast<float>(i % 360));
+		transforms.push_back(&transform);
+	}
+
+	hierarchy.Update();
+
+	suite.Run("transform_hierarchy_static", count, []() {}, [&hierarchy]() {
+		hierarchy.Update();
+	});
+
+	suite.Run("transform_hierarchy_1_percent_dirty", count, [&transforms]() {
+		for (size_t i = 0; i < transforms.size(); i += 100)
+			transforms[i]->ModifyLocal().Rotate(1.f);
+	}, [&hierarchy]() {
+		hierarchy.Update();
+	});
+
+	suite.Run("transform_hierarchy_all_dirty", count, [&transforms]() {
+		for (ae::TransformComponent* transform : transforms)
+			transform->ModifyLocal().Rotate(1.f);
+	}, [&hierarchy]() {
+		hierarchy.Update();
+	});
+
+	ResetEntityManager();
+}
+
+static void RunSnapshotBenchmarks(BenchmarkSuite& suite, size_t count) {
+	ResetEntityManager();
+
+	ae::EntityManager.RegisterSnapshotComponent<Position>("Position");
+	ae::EntityManager.RegisterSnapshotComponent<Velocity>("Velocity");
+
+	const ae::EntityGroup group = ae::EntityManager.CreateGroup();
+	CreateEntities(count, group);
+
+	float value = 0.f;
+	ae::EntityManager.ViewComponents<Position>([&value](Position& position) {
+		position.x = value++;
+		position.y = -value;
+	});
+	ae::EntityManager.ViewComponents<Velocity>([&value](Velocity& velocity) { velocity.x = value++; });
+
+	// killed entities are saved before Refresh removes them
+	size_t index = 0;
+	ae::EntityManager.ViewEntities([&index](ae::Entity& entity) {
+		if (index++ % 100 == 0)
+			entity.Kill();
+	});
+
+	const std::string filename = "AetherBenchmarks.snapshot";
+
+	suite.Run("save_snapshot", count, []() {}, [&filename]() {
+		ae::EntityManager.SaveSnapshot(filename);
+	});
+
+	suite.Run("load_snapshot", count, []() {}, [&filename]() {
+		ae::EntityManager.LoadSnapshot(filename);
+	});
+
+	std::remove(filename.c_str());
+	ResetEntityManager();
+}
+
+static std::vector<size_t> ParseSizes(const std::string& text) {
+	std::vector<size_t> sizes;
+	std::stringstream stream(text);
+	std::string size;
+
+	while (std::getline(stream, size, ','))
+		sizes.push_back(std::stoull(size));
+
+	return sizes;
+}
+
+int main(int argc, char** argv) {
+	std::vector<size_t> sizes = { 1000, 100000, 1000000 };
+	size_t repetitions = 5;
+	std::string label = "unnamed";
+	std::string output;
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string option = argv[i];
+
+		if (option == "--sizes")
+			sizes = ParseSizes(argv[i + 1]);
+		else if (option == "--repetitions")
+			repetitions = std::stoull(argv[i + 1]);
+		else if (option == "--label")
+			label = argv[i + 1];
+		else if (option == "--output")
+			output = argv[i + 1];
+		else {
+			std::cerr << "Unknown option '" << option << "'\n";
+			return 1;
+		}
+	}
+
+	// Application is not initialized, advanced views are registered and unregistered by the benchmarks
+	ae::internal::g_framework_settings.ecs_manage_advanced_views_manually = true;
+
+	BenchmarkSuite suite(repetitions);
+
+	for (size_t count : sizes) {
+		RunEntityManagerBenchmarks(suite, count);
+		RunSpatialBenchmarks(suite, count);
+		RunTransformBenchmarks(suite, count);
+		RunSnapshotBenchmarks(suite, count);
+	}
+
+	ResetEntityManager();
+
+	if (output.empty())
+		suite.WriteJson(std::cout, label);
+	else {
+		std::ofstream file(output);
+		suite.WriteJson(file, label);
+	}
+
+	return 0;
+}
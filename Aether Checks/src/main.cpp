@@ -0,0 +1,169 @@
+#include <Aether.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+// Headless correctness checks of the framework, no window nor GL context is created.
+//
+// Usage: AetherChecks
+// Failures are written to stderr, returns 1 if any check fails.
+
+struct Position : public ae::Component {
+	struct SnapshotData { float x, y; };
+
+	float x = 0.f, y = 0.f;
+
+	Position() = default;
+	Position(const SnapshotData& data) : x(data.x), y(data.y) {}
+	SnapshotData GetSnapshotData() const { return { x, y }; }
+};
+struct Velocity : public ae::Component {
+	struct SnapshotData { float x, y; };
+
+	float x = 1.f, y = 0.5f;
+
+	Velocity() = default;
+	Velocity(const SnapshotData& data) : x(data.x), y(data.y) {}
+	SnapshotData GetSnapshotData() const { return { x, y }; }
+};
+
+static void ResetEntityManager() {
+	ae::EntityManager.UnregisterAllAdvancedViews();
+	ae::EntityManager.Clear();
+	ae::EntityManager.Refresh();
+}
+
+// state compared by the snapshot round trip, entities in the order of AllEntitiesGroup followed by Position storage's order
+struct SnapshotState {
+	std::vector<float> entities; // alive, in group, position, velocity (-1 if missing)
+	std::vector<float> positions;
+
+	bool operator==(const SnapshotState& other) const { return entities == other.entities && positions == other.positions; }
+};
+
+static SnapshotState GetSnapshotState(ae::EntityGroup group) {
+	SnapshotState state;
+
+	ae::EntityManager.ViewEntities([&state, group](ae::Entity& entity) {
+		const Position& position = entity.GetComponent<Position>();
+		const bool moving = entity.HasComponent<Velocity>();
+
+		state.entities.insert(state.entities.end(), {
+			entity.IsAlive() ? 1.f : 0.f, 
+			entity.IsInGroup(group) ? 1.f : 0.f,
+			position.x, position.y,
+			moving ? entity.GetComponent<Velocity>().x : -1.f
+		});
+	});
+
+	ae::EntityManager.ViewComponents<Position>([&state](Position& position) { state.positions.push_back(position.x); });
+
+	return state;
+}
+
+// every other entity gets Velocity and belongs to 'group', every 100th one is killed but not removed yet,
+// the snapshot is loaded twice, so that storages refilled by a previous load are cleared and refilled as well
+static bool CheckSnapshotRoundTrip(size_t count) {
+	ResetEntityManager();
+
+	const ae::EntityGroup group = ae::EntityManager.CreateGroup();
+
+	for (size_t i = 0; i < count; i++) {
+		ae::Entity& entity = ae::EntityManager.CreateEntity();
+		entity.AddComponent<Position>();
+
+		if (i % 2 == 0) {
+			entity.AddComponent<Velocity>();
+			entity.AddToGroup(group);
+		}
+	}
+	ae::EntityManager.Refresh();
+
+	float value = 0.f;
+	ae::EntityManager.ViewComponents<Position>([&value](Position& position) {
+		position.x = value++;
+		position.y = -value;
+	});
+	ae::EntityManager.ViewComponents<Velocity>([&value](Velocity& velocity) { velocity.x = value++; });
+
+	size_t index = 0;
+	ae::EntityManager.ViewEntities([&index](ae::Entity& entity) {
+		if (index++ % 100 == 0)
+			entity.Kill();
+	});
+
+	const std::string filename = "AetherChecks.snapshot";
+	const SnapshotState saved = GetSnapshotState(group);
+
+	ae::EntityManager.SaveSnapshot(filename);
+
+	bool equal = true;
+
+	for (size_t load = 0; load < 2 && equal; load++) {
+		ae::EntityManager.LoadSnapshot(filename);
+		equal = (GetSnapshotState(group) == saved);
+	}
+
+	std::remove(filename.c_str());
+
+	if (!equal)
+		std::cerr << "Snapshot of " << count << " entities did not load back into the saved state\n";
+
+	ResetEntityManager();
+	return equal;
+}
+
+// every chunk throws once, on whichever thread takes it, the others must still be processed exactly once
+static bool CheckJobPoolExceptions() {
+	const size_t chunk_count = 64;
+
+	for (size_t throwing = 0; throwing < chunk_count; throwing++) {
+		std::atomic<size_t> processed = 0;
+		bool rethrown = false;
+
+		try {
+			ae::JobPool.ParallelFor(chunk_count, 1, [&processed, throwing](size_t begin, size_t) {
+				if (begin == throwing)
+					throw std::runtime_error("chunk failed");
+
+				processed++;
+			});
+		}
+		catch (const std::runtime_error&) {
+			rethrown = true;
+		}
+
+		if (!rethrown || processed != chunk_count - 1) {
+			std::cerr << "JobPool did not rethrow an exception of chunk " << throwing << " after processing the other chunks\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main() {
+
+	// Application is not initialized, advanced views are registered and unregistered by the checks
+	ae::internal::g_framework_settings.ecs_manage_advanced_views_manually = true;
+
+	// several workers, so that exceptions are thrown on workers as well as on the calling thread
+	if (ae::internal::g_framework_settings.job_pool_worker_count == 0 && std::thread::hardware_concurrency() < 4)
+		ae::internal::g_framework_settings.job_pool_worker_count = 3;
+
+	ae::EntityManager.RegisterSnapshotComponent<Position>("Position");
+	ae::EntityManager.RegisterSnapshotComponent<Velocity>("Velocity");
+
+	bool passed = CheckJobPoolExceptions();
+
+	for (size_t count : { 1, 1000, 100000 })
+		passed &= CheckSnapshotRoundTrip(count);
+
+	std::cerr << (passed ? "All checks passed\n" : "Some checks failed\n");
+	return passed ? 0 : 1;
+}
@@ -90,10 +90,19 @@
 #include "Structure/Cursor.hpp"
 #include "Structure/Clipboard.hpp"
 #include "Structure/StencilTest.hpp"
+#include "Structure/JobPool.hpp"
 
 #include "Structure/EntityComponentSystem/EntityManager.hpp"
 #include "Structure/EntityComponentSystem/Utility.hpp"
 #include "Structure/EntityComponentSystem/Entity.hpp"
 #include "Structure/EntityComponentSystem/Component.hpp"
 #include "Structure/EntityComponentSystem/ComponentPack.hpp"
-#include "Structure/EntityComponentSystem/ViewTag.hpp"
\ No newline at end of file
+#include "Structure/EntityComponentSystem/ViewTag.hpp"
+#include "Structure/EntityComponentSystem/ComponentQuery.hpp"
+#include "Structure/EntityComponentSystem/SystemScheduler.hpp"
+#include "Structure/EntityComponentSystem/EntityCommandBuffer.hpp"
+#include "Structure/EntityComponentSystem/Prefab.hpp"
+#include "Structure/EntityComponentSystem/Snapshot.hpp"
+#include "Structure/EntityComponentSystem/SpatialGrid.hpp"
+#include "Structure/EntityComponentSystem/Statistics.hpp"
+#include "Structure/EntityComponentSystem/TransformHierarchy.hpp"
\ No newline at end of file
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Radix Sort
+///
+///		GetSortOrder computes a stable ascending order of keys (float, double or integers), order[i] is the index of the key placed at i.
+///		Nearly sorted keys are sorted with insertion sort, which gives up after a number of moves proportional to the number of keys,
+///		other keys are sorted with LSD radix sort, 8 bits per pass, passes in which all keys share the same digit are skipped.
+/// 
+///		ApplySortOrder moves values into the given order in linear time, following the permutation's cycles.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+
+namespace ae {
+	namespace internal {
+
+		// map keys to unsigned integers of the same order
+		inline std::uint32_t ToRadixKey(float key) {
+			std::uint32_t bits;
+			std::memcpy(&bits, &key, sizeof(bits));
+			return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+		}
+		inline std::uint64_t ToRadixKey(double key) {
+			std::uint64_t bits;
+			std::memcpy(&bits, &key, sizeof(bits));
+			return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+		}
+		template <typename KeyType, typename = typename std::enable_if<std::is_integral<KeyType>::value>::type>
+		typename std::conditional<(sizeof(KeyType) > 4), std::uint64_t, std::uint32_t>::type ToRadixKey(KeyType key) {
+			typedef typename std::conditional<(sizeof(KeyType) > 4), std::uint64_t, std::uint32_t>::type RadixType;
+			typedef typename std::make_signed<RadixType>::type SignedType;
+
+			// flip the sign bit (of the sign-extended key), so that negative keys come first
+			if (std::is_signed<KeyType>::value)
+				return RadixType(SignedType(key)) ^ (RadixType(1) << (sizeof(RadixType) * 8 - 1));
+
+			return RadixType(key);
+		}
+
+		template <typename KeyType>
+		void GetSortOrder(const std::vector<KeyType>& keys, std::vector<std::uint32_t>& order) {
+			typedef decltype(ToRadixKey(KeyType())) RadixType;
+			constexpr size_t passes = sizeof(RadixType);
+
+			const size_t count = keys.size();
+
+			std::vector<RadixType> radix_keys(count);
+			for (size_t i = 0; i < count; i++)
+				radix_keys[i] = ToRadixKey(keys[i]);
+
+			order.resize(count);
+			std::iota(order.begin(), order.end(), 0);
+
+			// nearly sorted, insertion sort
+			const size_t max_moves = count * 4;
+			size_t moves = 0;
+
+			for (size_t marker = 1; marker < count && moves <= max_moves; marker++) {
+				const std::uint32_t index = order[marker];
+				const RadixType key = radix_keys[index];
+
+				size_t sub_marker = marker;
+				for (; sub_marker > 0 && radix_keys[order[sub_marker - 1]] > key; sub_marker--)
+					order[sub_marker] = order[sub_marker - 1];
+
+				order[sub_marker] = index;
+				moves += marker - sub_marker;
+			}
+
+			if (moves <= max_moves)
+				return;
+
+			// radix sort, count digits of all passes at once
+			std::iota(order.begin(), order.end(), 0);
+
+			std::vector<std::uint32_t> counts(passes * 256, 0);
+			for (RadixType key : radix_keys)
+				for (size_t pass = 0; pass < passes; pass++)
+					counts[pass * 256 + ((key >> (pass * 8)) & 0xFF)]++;
+
+			std::vector<std::uint32_t> sorted(count);
+
+			for (size_t pass = 0; pass < passes; pass++) {
+				std::uint32_t* digit_counts = &counts[pass * 256];
+				const size_t shift = pass * 8;
+
+				// all keys share this digit
+				if (digit_counts[(radix_keys[0] >> shift) & 0xFF] == count)
+					continue;
+
+				// counts to offsets
+				std::uint32_t offset = 0;
+				for (size_t digit = 0; digit < 256; digit++) {
+					const std::uint32_t digit_count = digit_counts[digit];
+					digit_counts[digit] = offset;
+					offset += digit_count;
+				}
+
+				for (std::uint32_t index : order)
+					sorted[digit_counts[(radix_keys[index] >> shift) & 0xFF]++] = index;
+
+				order.swap(sorted);
+			}
+		}
+
+		// values[i] becomes the value previously stored at order[i]
+		template <typename ValueType>
+		void ApplySortOrder(ValueType* values, const std::vector<std::uint32_t>& order) {
+			std::vector<bool> placed(order.size(), false);
+
+			for (size_t start = 0; start < order.size(); start++) {
+				if (placed[start] || order[start] == start)
+					continue;
+
+				ValueType value = std::move(values[start]);
+				size_t index = start;
+
+				while (order[index] != start) {
+					values[index] = std::move(values[order[index]]);
+					placed[index] = true;
+					index = order[index];
+				}
+
+				values[index] = std::move(value);
+				placed[index] = true;
+			}
+		}
+	}
+}
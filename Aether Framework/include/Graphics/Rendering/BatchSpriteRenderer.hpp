@@ -41,6 +41,16 @@
 ///		Batch sprites can be created only at the back of the renderer, meaning newly created sprite will be drawn last (at top).
 ///		Destruction can be done by sprite's index or pointer.'
 /// 
+///		Destroy() takes O(1), the last sprite takes the place (and the draw order position) of the destroyed one.
+///		Every quad uses the same index pattern, so the index buffer is never rewritten, only its end is dropped.
+/// 
+///		DestroyLater() preserves the order, the sprite is hidden and removed by Compact() in a single pass over all sprites,
+///		Compact() is called automatically by CreateBack(), Sort(), SortByKey() and Clear(),
+///		until then the sprite is still counted by GetCount() and its handle must not be used, its setters are ignored.
+/// 
+///		BatchSprite handles stay valid until their sprite is destroyed, indices may change.
+///		Destroyed BatchSprite objects are kept on a free list and reused by CreateBack().
+/// 
 /// Parameters:
 ///		Each BatchSprite has it's own transform, size, texture rect and color for each vertex,
 ///		although all share the same texture.
@@ -51,6 +61,8 @@
 ///		Sort() function is optimized for every-frame usage,
 ///		all bathces are sorted using insertion sort, 
 ///		their parameters can be easily reached and / or modified via passed compare function.
+///		SortByKey() extracts a float or integer key (for example depth) of every sprite once and sorts them using stable radix sort,
+///		it should be preferred when many sprites change their order, nearly sorted sprites are still sorted using insertion sort.
 ///		Sprites' indices are modified after sorting.
 ///
 /// Drawing:
@@ -59,6 +71,19 @@
 /// 
 ///		If texture was not set, 1 px white texture will be used instead.
 /// 
+///		Storage Buffer:
+///			When the context supports shader storage buffers (OpenGL 4.3+), transforms are uploaded to a storage buffer
+///			and the whole renderer is drawn with a single draw call, regardless of uniform limits.
+///			Only ranges of transforms changed since the last draw are uploaded.
+///			Otherwise, or after SetStorageBufferUsage(false), transforms are passed as uniforms in chunks of batch_sprite_max_draws_per_call.
+/// 
+///			Custom shaders used with the storage buffer have to read transforms from the buffer at binding 0,
+///			every transform is stored as 9 floats of column-major mat3, see batch_sprite_storage_shader below.
+/// 
+///		Vertex Buffer Mode:
+///			SetVertexBufferMode(VertexBufferMode::Streaming) makes vertices use persistently mapped ring buffers (see VertexArray.hpp),
+///			it is worth it when sprites' sizes, colors or texture rects change every frame.
+/// 
 /// Used Shaders:
 ///		Custom Parameters:
 ///			depend on machine:
@@ -103,16 +128,50 @@
 ///				vec2 normalized_coords = v_texcoords / vec2(textureSize(u_texture, 0)); 
 ///				a_color = texture(u_texture, normalized_coords) * v_color; 
 ///			}
+/// 
+///		Storage Buffer Vertex Shader (batch_sprite_storage_shader, fragment shader stays the same):
+///			#version 460 core 
+///			 
+///			layout(location = 0) in vec2 a_position; 
+///			layout(location = 1) in vec2 a_texcoords; 
+///			layout(location = 2) in vec4 a_color; 
+///			 
+///			out vec2 v_texcoords; 
+///			out vec4 v_color; 
+///			 
+///			layout(std430, binding = 0) readonly buffer Models 
+///			{ 
+///				float u_models[]; 
+///			}; 
+///			 
+///			uniform mat3 u_vp; 
+///			 
+///			void main() 
+///			{ 
+///				int i = (gl_VertexID / 4) * 9; 
+///				mat3 model = mat3( 
+///					u_models[i    ], u_models[i + 1], u_models[i + 2], 
+///					u_models[i + 3], u_models[i + 4], u_models[i + 5], 
+///					u_models[i + 6], u_models[i + 7], u_models[i + 8] 
+///				); 
+///				 
+///				gl_Position = vec4(u_vp * model * vec3(a_position, 1.0), 1.0); 
+///				v_texcoords = a_texcoords; 
+///				v_color = a_color; 
+///			}
 ///		
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
 #include "VertexArray.hpp"
+#include "BufferGPUHandler.hpp"
+#include "DirtyRanges.hpp"
 #include "../Matrix3x3.hpp"
 #include "../Color.hpp"
 #include "../Texture.hpp"
 #include "../Shader.hpp"
 #include "../../Structure/Camera.hpp"
+#include "../../Core/RadixSort.hpp"
 
 #include <vector>
 #include <memory>
@@ -150,6 +209,9 @@ namespace ae {
 
 		void Destroy(size_t index);
 		void Destroy(BatchSprite& batch);
+		void DestroyLater(size_t index);
+		void DestroyLater(BatchSprite& batch);
+		void Compact();
 		void Clear();
 
 		void Draw(const Shader& shader, const Matrix3x3& transform = Camera.GetProjViewMatrix()) const;
@@ -162,17 +224,36 @@ namespace ae {
 		void SetTexture(const Texture& texture);
 		const Texture* GetTexture() const;
 
+		// storage buffer is used only if the context supports it, even if usage is set to true
+		void SetStorageBufferUsage(bool use);
+		bool IsStorageBufferUsed() const;
+
+		void SetVertexBufferMode(VertexBufferMode mode);
+		VertexBufferMode GetVertexBufferMode() const;
+
 		BatchSprite& Get(size_t index) const;
 		size_t GetCount() const;
 
 		void Sort(const std::function<bool(const BatchSprite& left, const BatchSprite& right)>& compare);
 
+		// KeyFunctionType returns a float or an integer key of a sprite, sprites with lower keys are drawn first
+		template <typename KeyFunctionType>
+		void SortByKey(const KeyFunctionType& key);
+
 	private:
 		const Texture* m_texture = nullptr;
 
 		VertexArray<VertexBatchSprite> m_vertices;
 		std::vector<std::unique_ptr<BatchSprite>> m_batches;
+		std::vector<std::unique_ptr<BatchSprite>> m_free_batches;
 		std::vector<Matrix3x3> m_transforms;
+		size_t m_pending_destruction_count = 0;
+
+		bool m_storage_buffer_usage = true;
+		mutable internal::DirtyRanges m_dirty_transforms;
+		mutable internal::BufferGPUHandler m_transform_buffer{ 0x90D2 }; // GL_SHADER_STORAGE_BUFFER
+
+		void Reorder(const std::vector<std::uint32_t>& order);
 	};
 
 	// Batch
@@ -200,6 +281,7 @@ namespace ae {
 	private:
 		BatchSpriteRenderer* m_renderer;
 		size_t m_index;
+		bool m_pending_destruction = false;
 
 		BatchSprite() = default;
 		BatchSprite(const BatchSprite&) = delete;
@@ -211,4 +293,22 @@ namespace ae {
 	void BatchSpriteRenderer::Draw(const std::function<void(const Texture*, size_t batch_count, const std::vector<Matrix3x3>&, const VertexArray<VertexBatchSprite>&, HandlerTypes& ...handlers)>& draw, HandlerTypes& ...handlers) const {
 		draw(m_texture, GetCount(), m_transforms, m_vertices, handlers...);
 	}
+
+	template <typename KeyFunctionType>
+	void BatchSpriteRenderer::SortByKey(const KeyFunctionType& key) {
+		Compact();
+
+		// extract keys once
+		std::vector<decltype(key(std::declval<const BatchSprite&>()))> keys;
+		keys.reserve(GetCount());
+
+		for (const auto& batch : m_batches)
+			keys.push_back(key(*batch));
+
+		// stable radix sort
+		std::vector<std::uint32_t> order;
+		internal::GetSortOrder(keys, order);
+
+		Reorder(order);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "VertexArrayGPUHandler.hpp"
+#include "../../Core/Preprocessor.hpp"
+
+#include <cstdint>
+
+namespace ae {
+	namespace internal {
+
+		// Single OpenGL buffer used outside of VertexArray, e.g. shader storage or per-instance data,
+		// capacity grows geometrically, so updates of the same or smaller size never reallocate
+		struct BufferGPUHandler {
+			std::uint32_t m_buffer_id;
+			std::uint32_t m_target;
+			size_t m_byte_capacity = 0;
+
+			BufferGPUHandler(std::uint32_t gl_target);
+			BufferGPUHandler(const BufferGPUHandler& copy);
+			BufferGPUHandler(BufferGPUHandler&& move) noexcept;
+			~BufferGPUHandler();
+
+			void operator=(const BufferGPUHandler& copy);
+			void operator=(BufferGPUHandler&& move) noexcept;
+
+			void Bind() const;
+			void BindBase(std::uint32_t binding) const;
+
+			// adds an attribute read once per instance from this buffer to the currently bound vertex array
+			void AddInstanceAttribute(std::uint32_t location, const VertexAttributeTypeInfo& ati, bool normalize, size_t byte_size, size_t byte_offset) const;
+
+			// returns true if the buffer was reallocated, previous content is lost then
+			bool Reserve(size_t byte_size);
+
+			// ensures capacity for byte_size bytes and uploads them from the beginning of the buffer
+			void Update(size_t byte_size, const void* data);
+			void UpdateRange(size_t byte_offset, size_t byte_size, const void* data) const;
+
+		private:
+
+			void CopyFrom(const BufferGPUHandler& copy);
+			void MoveFrom(BufferGPUHandler&& move) noexcept;
+		};
+
+	} // internal
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace ae {
+	namespace internal {
+
+		// Sorted, merged [first, last) ranges of elements modified since the last upload,
+		// overlapping and adjacent ranges are merged, above c_max_ranges the two closest ranges are merged
+		class DirtyRanges {
+		public:
+			static constexpr size_t c_max_ranges = 16;
+
+			void Add(size_t first, size_t last);
+			void Add(const DirtyRanges& other);
+			void AddAll();
+			void Clear();
+
+			bool IsEmpty() const;
+
+			// calls function(first, last) for every range clamped to [0, size)
+			template <typename FunctionType>
+			void ForEach(size_t size, const FunctionType& function) const;
+
+		private:
+			std::vector<std::pair<size_t, size_t>> m_ranges;
+			bool m_all = false;
+		};
+
+		// Previous template definitions
+		template <typename FunctionType>
+		void DirtyRanges::ForEach(size_t size, const FunctionType& function) const {
+			if (m_all) {
+				if (size != 0)
+					function(size_t(0), size);
+
+				return;
+			}
+
+			for (const auto& range : m_ranges) {
+				if (range.first >= size)
+					break;
+
+				function(range.first, std::min(range.second, size));
+			}
+		}
+	}
+}
@@ -38,9 +38,14 @@
 ///		It stores and manages all instances and their parameters.
 /// 
 /// Parameters:
-///		Renderer stores a quad as vertices (one size, one texturecoords) and one texture for all the instances
-///		and a color, and transform for each individual instance.
+///		Renderer stores a quad as vertices (one size) and one texture for all the instances
+///		and a color, transform and texture rectangle for each individual instance.
+///		Quad's texture coordinates are unit corners (0, 0) - (1, 1), the shader maps them onto the instance's texture rectangle,
+///		so each instance can show a different frame of a sprite sheet.
 ///		
+///		SetTextureRect() of the renderer sets the texture rectangle of every instance and of instances created later,
+///		InstancedSprite::SetTextureRect() changes only one instance.
+/// 
 ///		First time when the texture is set,
 ///			if size was not set before it becomes texture size,
 ///			and if texture rectangle was not set it becomes IntRect({0, 0}, texture size).
@@ -49,38 +54,45 @@
 ///		Sort() function is optimized for every-frame usage,
 ///		all instances are sorted using insertion sort, 
 ///		their parameters can be easily reached and / or modified via passed compare function.
+///		SortByKey() extracts a float or integer key (for example depth) of every sprite once and sorts them using stable radix sort,
+///		it should be preferred when many sprites change their order, nearly sorted sprites are still sorted using insertion sort.
 ///		Instances' indices are modified after sorting.
 /// 
 /// Drawing:
 ///		Drawing is done by passing global transform for all instances, custom shader can be set.
 ///		Also, user-defined draw function can be used instead.
 /// 
+///		Per-instance data is kept in instance buffers read with attribute divisor 1 and drawn with a single glDrawElementsInstanced call.
+///		Transforms, colors and texture rectangles are stored in separate buffers,
+///		only the ranges of instances changed since the last draw are uploaded to each of them.
+/// 
 ///		If texture was not set, 1 px white texture will be used instead.
 /// 
 /// Used Shaders:
 /// 
-///		Custom Parameters (depend on machine):
-///			constexpr size_t mat3_comp_count = 12, vec4_comp_count = 4;
-///			instanced_sprite_max_draws_per_call = static_cast<size_t>((Shader::RetrieveInfo.MaxUniformComponentsVertex() - mat3_comp_count) / (mat3_comp_count + vec4_comp_count));
+///		Attributes:
+///			0 - quad position, 1 - quad unit texture coordinates,
+///			2, 3, 4 - transform columns, 5 - color, 6 - texture rectangle (left, top, width, height).
 ///
 ///		Vertex Shader:
 ///			#version 460 core 
 ///			 
 ///			layout(location = 0) in vec2 a_position; 
 ///			layout(location = 1) in vec2 a_texcoords; 
+///			layout(location = 2) in mat3 a_model; 
+///			layout(location = 5) in vec4 a_color; 
+///			layout(location = 6) in vec4 a_texture_rect; 
 ///			 
 ///			out vec2 v_texcoords; 
 ///			out vec4 v_color; 
 ///			 
-///			uniform vec4 u_colors[instanced_sprite_max_draws_per_call]; // custom parameter set on shader creation, it depends on machine
-///			uniform mat3 u_models[instanced_sprite_max_draws_per_call]; 
 ///			uniform mat3 u_vp; 
 ///			 
 ///			void main() 
 ///			{ 
-///				gl_Position = vec4(u_vp * u_models[gl_InstanceID] * vec3(a_position, 1.0), 1.0); 
-///				v_texcoords = a_texcoords; 
-///				v_color = u_colors[gl_InstanceID]; 
+///				gl_Position = vec4(u_vp * a_model * vec3(a_position, 1.0), 1.0); 
+///				v_texcoords = a_texture_rect.xy + a_texcoords * a_texture_rect.zw; 
+///				v_color = a_color; 
 ///			}
 ///		
 ///		Fragment Shader:
@@ -103,11 +115,14 @@
 #pragma once
 
 #include "VertexArray.hpp"
+#include "BufferGPUHandler.hpp"
+#include "DirtyRanges.hpp"
 #include "../Matrix3x3.hpp"
 #include "../Color.hpp"
 #include "../Texture.hpp"
 #include "../Shader.hpp"
 #include "../../Structure/Camera.hpp"
+#include "../../Core/RadixSort.hpp"
 
 #include <vector>
 #include <memory>
@@ -131,6 +146,8 @@ namespace ae {
 
 		InstancedSprite& Create(size_t index, const Matrix3x3& transform = Matrix3x3::Identity, const Color& color = Color());
 		InstancedSprite& CreateBack(const Matrix3x3& transform = Matrix3x3::Identity, const Color& color = Color());
+		InstancedSprite& Create(size_t index, const Matrix3x3& transform, const Color& color, const IntRect& texture_rect);
+		InstancedSprite& CreateBack(const Matrix3x3& transform, const Color& color, const IntRect& texture_rect);
 		void Destroy(size_t index);
 		void Destroy(InstancedSprite* instance);
 		void Clear();
@@ -140,6 +157,10 @@ namespace ae {
 
 		void Sort(const std::function<bool(const InstancedSprite& left, const InstancedSprite& right)>& compare);
 
+		// KeyFunctionType returns a float or an integer key of a sprite, sprites with lower keys are drawn first
+		template <typename KeyFunctionType>
+		void SortByKey(const KeyFunctionType& key);
+
 		void Draw(const Shader& shader, const Matrix3x3& transform = Camera.GetProjViewMatrix()) const;
 		void Draw(const Matrix3x3& transform = Camera.GetProjViewMatrix()) const;
 		void Draw(const std::function<void(const Texture*, size_t instance_count, const std::vector<Matrix3x3>&, const std::vector<Vector4f>&, const VertexArray<VertexPosTex>&)>& draw) const;
@@ -161,11 +182,18 @@ namespace ae {
 		const Texture* m_texture = nullptr;
 		IntRect m_texture_rect;
 
-		void UpdateTextureCoords();
-
 		std::vector<std::unique_ptr<InstancedSprite>> m_instances;
 		std::vector<Matrix3x3> m_transforms;
 		std::vector<Vector4f> m_colors;
+		std::vector<IntRect> m_texture_rects;
+		void Reorder(const std::vector<std::uint32_t>& order);
+
+		mutable internal::BufferGPUHandler m_transform_buffer{ 0x8892 }, m_color_buffer{ 0x8892 }, m_texture_rect_buffer{ 0x8892 }; // GL_ARRAY_BUFFER
+		mutable internal::DirtyRanges m_dirty_transforms, m_dirty_colors, m_dirty_texture_rects;
+
+		void AddInstanceAttributes();
+		void MarkDirty(size_t first_index, size_t last_index);
+		void UpdateInstanceBuffers() const;
 	};
 
 	// Instance
@@ -181,6 +209,9 @@ namespace ae {
 		void SetColor(const Color& color);
 		Color GetColor() const;
 
+		void SetTextureRect(const IntRect& rect);
+		const IntRect& GetTextureRect() const;
+
 		InstancedSpriteRenderer& GetRenderer() const;
 		size_t GetIndex() const;
 
@@ -199,4 +230,21 @@ namespace ae {
 		draw(m_texture, GetCount(), m_transforms, m_colors, m_vertices, handlers...);
 	}
 
+	template <typename KeyFunctionType>
+	void InstancedSpriteRenderer::SortByKey(const KeyFunctionType& key) {
+
+		// extract keys once
+		std::vector<decltype(key(std::declval<const InstancedSprite&>()))> keys;
+		keys.reserve(GetCount());
+
+		for (const auto& instance : m_instances)
+			keys.push_back(key(*instance));
+
+		// stable radix sort
+		std::vector<std::uint32_t> order;
+		internal::GetSortOrder(keys, order);
+
+		Reorder(order);
+	}
+
 }
\ No newline at end of file
@@ -80,10 +80,25 @@
 ///		BUT remember! Both do not ensure GPU update when drawing comes,
 ///		thus one of these functions must be also called:
 ///			> EnsureSizeUpdate() if one of the containers' size has changed
-///			> EnsureParameterUpdate() if the size was not changed, but the container was modified in other way.
+///			> EnsureParameterUpdate() if the size was not changed, but the container was modified in other way,
+///			> EnsureVerticesUpdate(first, last) and EnsureIndicesUpdate(first, last) if only given elements were modified.
 /// 
 ///		There are also few functions that let you modify data and automaticaly ensure updates.
 /// 
+///	GPU Updates:
+///		Modified vertices and indices are tracked separately as merged ranges and only these ranges are uploaded before drawing,
+///		e.g. SetVertex() uploads a single vertex and leaves indices untouched.
+///		GPU buffers' capacity grows geometrically and is never shrunk, so appending rarely reallocates them.
+/// 
+///		Uploaded bytes, upload calls and reallocations of the last tick can be retrieved using Application.GetUploadStats().
+/// 
+///	Buffer Mode:
+///		SetBufferMode(mode) selects how data is sent to GPU, it binds the vertex array and uploads all data again on next draw:
+///			> VertexBufferMode::Dynamic (default) uses glBufferData and glBufferSubData,
+///			> VertexBufferMode::Streaming uses persistently mapped, triple buffered ring buffers (glBufferStorage),
+///			  modified ranges are copied straight into GPU-visible memory of the region GPU is no longer reading (guarded by fence sync),
+///			  so updates never wait for the driver, it is meant for geometry changing every frame and requires OpenGL 4.4, otherwise Dynamic is used.
+/// 
 /// Drawing:
 ///		Before drawing VertexArray has to be bound.
 /// 
@@ -99,6 +114,7 @@
 
 #include "../../Core/Preprocessor.hpp"
 #include "VertexArrayGPUHandler.hpp"
+#include "DirtyRanges.hpp"
 
 #include <vector>
 
@@ -166,6 +182,9 @@ namespace ae {
 		void SetDrawMode(DrawMode mode);
 		DrawMode GetDrawMode() const;
 
+		void SetBufferMode(VertexBufferMode mode);
+		VertexBufferMode GetBufferMode() const;
+
 		void Append(const std::vector<VertexType>& vertices, const std::vector<unsigned int>& indices);
 
 		void SetVertices(const std::vector<VertexType>& vertices);
@@ -195,6 +214,10 @@ namespace ae {
 		void EnsureParameterUpdate() const;
 		void EnsureSizeUpdate() const;
 
+		// last index is included
+		void EnsureVerticesUpdate(size_t first_index, size_t last_index) const;
+		void EnsureIndicesUpdate(size_t first_index, size_t last_index) const;
+
 		void Clear();
 
 		void Draw() const;
@@ -206,9 +229,9 @@ namespace ae {
 		void Unbind() const;
 		
 	private:
-		internal::VertexArrayGPUHandler m_handler;
+		mutable internal::VertexArrayGPUHandler m_handler;
 
-		mutable bool m_size_changed = false, m_parameter_updated = false;
+		mutable internal::DirtyRanges m_dirty_vertices, m_dirty_indices;
 
 		std::vector<VertexType> m_vertices;
 		std::vector<unsigned int> m_indices;
@@ -240,8 +263,12 @@ namespace ae {
 	VertexArray<VertexType>& VertexArray<VertexType>::operator=(const VertexArray<VertexType>& other) {
 		m_handler = other.m_handler;
 
-		m_size_changed = other.m_size_changed;
-		m_parameter_updated = other.m_parameter_updated;
+		m_dirty_vertices = other.m_dirty_vertices;
+		m_dirty_indices = other.m_dirty_indices;
+
+		// streaming buffers' content is not copied
+		if (m_handler.GetMode() == VertexBufferMode::Streaming)
+			EnsureSizeUpdate();
 
 		m_vertices = other.m_vertices;
 		m_indices = other.m_indices;
@@ -254,8 +281,8 @@ namespace ae {
 	VertexArray<VertexType>& VertexArray<VertexType>::operator=(VertexArray<VertexType>&& other) noexcept {
 		m_handler = std::move(other.m_handler);
 
-		m_size_changed = other.m_size_changed;
-		m_parameter_updated = other.m_parameter_updated;
+		m_dirty_vertices = std::move(other.m_dirty_vertices);
+		m_dirty_indices = std::move(other.m_dirty_indices);
 
 		m_vertices = std::move(other.m_vertices);
 		m_indices = std::move(other.m_indices);
@@ -270,49 +297,61 @@ namespace ae {
 	template <typename VertexType>
 	DrawMode VertexArray<VertexType>::GetDrawMode() const { return m_draw_mode; }
 
+	template <typename VertexType>
+	void VertexArray<VertexType>::SetBufferMode(VertexBufferMode mode) {
+		if (mode == m_handler.GetMode())
+			return;
+
+		m_handler.SetMode(mode);
+		EnsureSizeUpdate();
+	}
+	template <typename VertexType>
+	VertexBufferMode VertexArray<VertexType>::GetBufferMode() const { return m_handler.GetMode(); }
+
 	template <typename VertexType>
 	void VertexArray<VertexType>::Append(const std::vector<VertexType>& vertices, const std::vector<unsigned int>& indices) {
 
+		// Update only appended data
+		m_dirty_vertices.Add(m_vertices.size(), m_vertices.size() + vertices.size());
+		m_dirty_indices.Add(m_indices.size(), m_indices.size() + indices.size());
+
 		// Append cache data
 		m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
 		m_indices.insert(m_indices.end(), indices.begin(), indices.end());
-
-		// Update
-		m_size_changed = true;
 	}
 
 	template <typename VertexType>
 	void VertexArray<VertexType>::SetVertices(const std::vector<VertexType>& vertices) {
 		m_vertices = vertices;
-		m_size_changed = true;
+		m_dirty_vertices.AddAll();
 
 	}
 	template <typename VertexType>
 	void VertexArray<VertexType>::SetIndices(const std::vector<unsigned int>& indices) {
 		m_indices = indices;
-		m_size_changed = true;
+		m_dirty_indices.AddAll();
 	}
 	template <typename VertexType>
 	void VertexArray<VertexType>::InsertVertices(const std::vector<VertexType>& vertices, size_t index) {
 		m_vertices.insert(m_vertices.begin() + index, vertices.begin(), vertices.end());
-		m_size_changed = true;
+		m_dirty_vertices.Add(index, m_vertices.size());
 	}
 
 	template <typename VertexType>
 	void VertexArray<VertexType>::InsertIndices(const std::vector<unsigned int>& indices, size_t index){
 		m_indices.insert(m_indices.begin() + index, indices.begin(), indices.end());
-		m_size_changed = true;
+		m_dirty_indices.Add(index, m_indices.size());
 	}
 
 	template <typename VertexType>
 	void VertexArray<VertexType>::EraseVertices(size_t first_index, size_t last_index) {
 		m_vertices.erase(m_vertices.begin() + first_index, m_vertices.begin() + (last_index + 1));
-		m_size_changed = true;
+		m_dirty_vertices.Add(first_index, m_vertices.size());
 	}
 	template <typename VertexType>
 	void VertexArray<VertexType>::EraseIndices(size_t first_index, size_t last_index) {
 		m_indices.erase(m_indices.begin() + first_index, m_indices.begin() + (last_index + 1 ));
-		m_size_changed = true;
+		m_dirty_indices.Add(first_index, m_indices.size());
 	}
 
 	template <typename VertexType>
@@ -328,12 +367,12 @@ namespace ae {
 	template <typename VertexType>
 	void VertexArray<VertexType>::SetVertex(size_t array_index, const VertexType& vertex) {
 		m_vertices.at(array_index) = vertex;
-		m_parameter_updated = true;
+		m_dirty_vertices.Add(array_index, array_index + 1);
 	}
 	template <typename VertexType>
 	void VertexArray<VertexType>::SetIndex(size_t array_index, unsigned int index) {
 		m_indices.at(array_index) = index;
-		m_parameter_updated = true;
+		m_dirty_indices.Add(array_index, array_index + 1);
 	}
 
 	template <typename VertexType>
@@ -345,10 +384,26 @@ namespace ae {
 		return m_indices.at(array_index);
 	}
 	template <typename VertexType>
-	void VertexArray<VertexType>::EnsureParameterUpdate() const { m_parameter_updated = true; }
+	void VertexArray<VertexType>::EnsureParameterUpdate() const {
+		m_dirty_vertices.AddAll();
+		m_dirty_indices.AddAll();
+	}
+
+	template <typename VertexType>
+	void VertexArray<VertexType>::EnsureSizeUpdate() const {
+		m_dirty_vertices.AddAll();
+		m_dirty_indices.AddAll();
+	}
+
+	template <typename VertexType>
+	void VertexArray<VertexType>::EnsureVerticesUpdate(size_t first_index, size_t last_index) const {
+		m_dirty_vertices.Add(first_index, last_index + 1);
+	}
 
 	template <typename VertexType>
-	void VertexArray<VertexType>::EnsureSizeUpdate() const { m_size_changed = true; }
+	void VertexArray<VertexType>::EnsureIndicesUpdate(size_t first_index, size_t last_index) const {
+		m_dirty_indices.Add(first_index, last_index + 1);
+	}
 
 	template <typename VertexType>
 	std::vector<VertexType>& VertexArray<VertexType>::GetCPUVertices() { return m_vertices; }
@@ -367,7 +422,10 @@ namespace ae {
 		if (!m_vertices.empty() || !m_indices.empty()) {
 			m_vertices.clear();
 			m_indices.clear();
-			m_size_changed = true;
+
+			// nothing is left to upload, GPU buffers keep their capacity
+			m_dirty_vertices.Clear();
+			m_dirty_indices.Clear();
 		}
 	}
 
@@ -417,23 +475,10 @@ namespace ae {
 
 	template <typename VertexType>
 	void VertexArray<VertexType>::Update() const {
-		if (m_size_changed) {
-			m_handler.UpdateReallocate(
-				sizeof(VertexType)   * m_vertices.size(), m_vertices.data(), 
-				sizeof(unsigned int) * m_indices.size(),  m_indices.data()
-			);
-
-			m_size_changed = false;
-			m_parameter_updated = false;
-		}
-		else if (m_parameter_updated) {
-			m_handler.Update(
-				sizeof(VertexType) * m_vertices.size(), m_vertices.data(),
-				sizeof(unsigned int) * m_indices.size(), m_indices.data()
-			);
-
-			m_parameter_updated = false;
-		}
+		m_handler.Update(
+			m_vertices.data(), sizeof(VertexType), m_vertices.size(), m_dirty_vertices,
+			m_indices.data(), m_indices.size(), m_dirty_indices
+		);
 	}
 
 }
\ No newline at end of file
@@ -36,6 +36,8 @@
 #include "../../System/Vector3.hpp"
 #include "../../System/Vector4.hpp"
 #include "../Color.hpp"
+#include "GPUUploadStats.hpp"
+#include "DirtyRanges.hpp"
 
 #include "../../System/LogError.hpp"
 #include "../../Core/Preprocessor.hpp"
@@ -47,6 +49,13 @@
 	(handler.m_vao_id == ae::internal::VertexArrayGPUHandler::s_bound_vao_id)
 
 namespace ae {
+
+	// How vertex array's data is sent to GPU
+	enum class VertexBufferMode : std::uint8_t {
+		Dynamic,	// glBufferData / glBufferSubData
+		Streaming	// persistently mapped ring buffer written directly, requires OpenGL 4.4
+	};
+
 	namespace internal {
 
 		// Important informations for adding layout
@@ -124,9 +133,25 @@ namespace ae {
 
 			// OpenGL object ids
 			std::uint32_t m_vao_id, m_vbo_id, m_ebo_id;
+			size_t m_vbo_byte_capacity = 0, m_ebo_byte_capacity = 0;
+
+			// Streaming, buffers are divided into regions, the least recently written region is filled
+			// after its fence signals that GPU stopped reading it, attributes point to the region written last
+			static constexpr size_t c_stream_region_count = 3;
+
+			VertexBufferMode m_mode = VertexBufferMode::Dynamic;
+			size_t m_region = 0;
+			size_t m_stream_vertex_capacity = 0, m_stream_index_capacity = 0; // per region, in elements
+			void* m_vbo_map = nullptr;
+			void* m_ebo_map = nullptr;
+			mutable void* m_fences[c_stream_region_count] = {};
+			DirtyRanges m_region_dirty_vertices[c_stream_region_count], m_region_dirty_indices[c_stream_region_count];
 
 			AE_DEBUG_ONLY(static std::uint32_t s_bound_vao_id);
 
+			// counted since Application's last tick
+			static GPUUploadStats s_upload_stats;
+
 			// Functions to communicate with OpenGL
 			VertexArrayGPUHandler();
 			VertexArrayGPUHandler(const VertexArrayGPUHandler& copy);
@@ -144,14 +169,39 @@ namespace ae {
 			void Draw(std::int32_t draw_mode, size_t start_index_index, size_t indices_count) const;
 			void DrawInstanced(std::int32_t draw_mode, size_t start_index_index, size_t indices_count, size_t instance_count) const;
 
-			void UpdateReallocate(size_t vertices_byte_size, const void* vertices_data, size_t indices_byte_size, const void* indices_data) const;
-			void Update(size_t vertices_byte_size, const void* vertices_data, size_t indices_byte_size, const void* indices_data) const;
+			// recreates buffers, data has to be uploaded again, leaves the vertex array bound
+			void SetMode(VertexBufferMode mode);
+			VertexBufferMode GetMode() const;
+
+			// uploads dirty ranges and clears them, capacity grows geometrically
+			void Update(
+				const void* vertices, size_t vertex_byte_size, size_t vertex_count, DirtyRanges& dirty_vertices,
+				const void* indices, size_t index_count, DirtyRanges& dirty_indices
+			);
 
 		private:
+			static bool Reserve(std::uint32_t gl_target, std::uint32_t buffer_id, size_t& byte_capacity, size_t byte_size);
+			static void UpdateRange(std::uint32_t gl_target, std::uint32_t buffer_id, size_t byte_offset, size_t byte_size, const void* data);
+
+			void UpdateStreaming(
+				const void* vertices, size_t vertex_byte_size, size_t vertex_count, const DirtyRanges& dirty_vertices,
+				const void* indices, size_t index_count, const DirtyRanges& dirty_indices
+			);
+			void ReserveStreaming(size_t vertex_byte_size, size_t vertex_count, size_t index_count);
+			void* AllocateStreamingBuffer(std::uint32_t gl_target, std::uint32_t& buffer_id, size_t byte_size);
+			void ReleaseStreaming();
+
+			void WaitForRegion(size_t region) const;
+			void FenceRegion() const;
+			size_t GetIndexOffset() const;
+
+			void BindAttributes(size_t byte_offset) const;
+
 			void AllocateBuffers();
 			void DeallocateBuffers();
 
 			void CopyFrom(const VertexArrayGPUHandler& copy);
+			void CopyBuffers(const VertexArrayGPUHandler& copy);
 			void MoveFrom(VertexArrayGPUHandler&& move) noexcept;
 		};
 
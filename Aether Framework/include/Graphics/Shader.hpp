@@ -53,6 +53,7 @@
 /// 
 /// Information: 
 ///		RetrieveInfo static object is used for retrieving devices shader limits, such as uniform component count or texture unit limit for fragment shader.
+///		MaxShaderStorageBlocksVertex() returns 0 when the context does not support shader storage buffers.
 /// 
 ///		Component count for glsl types:
 ///			Type:			       count:  count in array:
@@ -60,6 +60,9 @@ namespace ae {
 				static size_t MaxUniformComponentsTessEval();
 				static size_t MaxUniformComponentsCompute();
 
+				// returns 0 if the context does not support shader storage buffers (OpenGL < 4.3)
+				static size_t MaxShaderStorageBlocksVertex();
+
 			private:
 				RetrieveInformationFunctions() = default;
 				RetrieveInformationFunctions(const RetrieveInformationFunctions&) = default;
@@ -43,10 +43,11 @@
 /// Main Loop & Running:
 ///		1. Poll events,
 ///		2. Update the scene currently on top,
-///		3. Draw layers if window is visible,
-///		4. Refresh scenes (possibly jump to next)
-///		5. Refresh entities (this can be turned off using a framework setting)
-///		6. Update tick time
+///		3. Update systems (see SystemScheduler.hpp),
+///		4. Draw layers if window is visible,
+///		5. Refresh scenes (possibly jump to next)
+///		6. Refresh entities (this can be turned off using a framework setting)
+///		7. Update tick time and GPU upload statistics
 /// 
 /// Closing:
 ///		The application will automatically close if SceneManager is empty or when Close() is called
@@ -55,6 +56,9 @@
 ///		GetTickTime() returns the time of the last iteration of the main loop,
 ///		GetRunTime() return time elapsed since begining of main loop.
 /// 
+/// Statistics:
+///		GetUploadStats() returns bytes, calls and reallocations of GPU buffer uploads done during the last iteration of the main loop.
+/// 
 /// FrameworkSettings:
 ///		Enable or disable different features.
 /// 
@@ -64,6 +68,24 @@
 ///		ecs_manage_advanced_views_manually: (default value: false)
 ///			if set to true, makes the user responsible for managing advanced entity/entity group views, possible performance improvement,
 /// 
+///		ecs_preserve_view_order: (default value: false)
+///			if set to true, removing an entity from an advanced view shifts the following entities (O(n)) instead of swapping it with the last one (O(1)),
+///			it covers advanced views only, component storages and groups keep their order on Refresh and Clear regardless of it,
+///			and never keep it on immediate removals (see EntityManager.hpp),
+/// 
+///		ecs_advanced_view_max_age: (default value: 0)
+///			if greater than 0, advanced views which have not been used (viewed, counted, sorted, retrieved) during this many Refresh calls are unregistered,
+///			so that structural changes stop updating them, ignored if advanced views are managed manually,
+/// 
+///		ecs_max_advanced_views: (default value: 0)
+///			if greater than 0, least recently used advanced views above this number are unregistered by Refresh, ignored if advanced views are managed manually,
+/// 
+///		ecs_detailed_statistics: (default value: false)
+///			if set to true, EntityManager also measures the time of incremental updates of advanced views (see Statistics.hpp),
+/// 
+///		job_pool_worker_count: (default value: 0)
+///			defines the number of JobPool's worker threads, 0 - one less than the number of hardware threads,
+/// 
 ///		log_errors: (default value: true)
 ///			if set to true, stops Aether Framework from outputting crashes if set to false,
 /// 
@@ -78,6 +100,7 @@
 #include "../System/Vector2.hpp"
 #include "../System/Time.hpp"
 #include "../System/Events/Event.hpp"
+#include "../Graphics/Rendering/GPUUploadStats.hpp"
 
 #include "Window.hpp"
 
@@ -88,6 +111,11 @@ namespace ae {
 	struct FrameworkSettings {
 		bool ecs_refresh_entities_each_tick = true;
 		bool ecs_manage_advanced_views_manually = false;
+		bool ecs_preserve_view_order = false;
+		size_t ecs_advanced_view_max_age = 0;
+		size_t ecs_max_advanced_views = 0;
+		bool ecs_detailed_statistics = false;
+		size_t job_pool_worker_count = 0;
 		bool log_errors = true;
 		std::string log_errors_file = "error_log.txt";
 	};
@@ -109,11 +137,14 @@ namespace ae {
 			const Time& GetTickTime() const;
 			Time GetRunTime() const;
 
+			const GPUUploadStats& GetUploadStats() const;
+
 			void SetCloseCallback(const std::function<void()>& callback);
 
 		private:
 			bool m_should_close;
 			Time m_ticktime, m_start_time;
+			GPUUploadStats m_upload_stats;
 
 			std::function<void()> m_close_callback;
 
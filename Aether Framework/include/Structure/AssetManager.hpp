@@ -167,9 +167,10 @@ namespace ae {
 			Font inter_regular_font;
 			SoundBuffer water_splash_soundbuffer;
 			Shader instanced_sprite_shader;
-			size_t instanced_sprite_max_draws_per_call;
 			Shader batch_sprite_shader;
 			size_t batch_sprite_max_draws_per_call;
+			Shader batch_sprite_storage_shader;
+			bool batch_sprite_storage_supported;
 		};
 	}
 
@@ -32,11 +32,18 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace ae {
 	class Entity;
 
+	namespace internal {
+		class ComponentStorageBase;
+	}
+
 	class Component {
 		friend class Entity;
+		friend class internal::ComponentStorageBase;
 
 	public:
 		virtual ~Component() = default;
@@ -50,5 +57,8 @@ namespace ae {
 		Component() = default;
 		Component(const Component&) = delete;
 		Component(Component&&) = delete;
+
+	private:
+		std::uint32_t m_storage_position = 0; // in storage's dense vector
 	};
 }
\ No newline at end of file
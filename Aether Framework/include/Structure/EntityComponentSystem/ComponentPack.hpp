@@ -34,29 +34,32 @@
 
 #include "Utility.hpp"
 
-#include <set>
+#include <type_traits>
 
 namespace ae {
 	namespace internal { class EntityManagerType; }
 	class Component;
 
 	template <typename...ComponentTypes>
-	struct ComponentPack : public ComponentPack<> {
-		ComponentPack<ComponentTypes...>();
-	};
+	struct ComponentPack;
 
 	template<>
 	class ComponentPack<> {
 		friend internal::EntityManagerType;
 
 	protected:
-		std::set<internal::ComponentTypeId> m_components;
+		internal::ComponentSignature m_components;
+	};
+
+	template <typename...ComponentTypes>
+	struct ComponentPack : public ComponentPack<> {
+		ComponentPack();
 	};
 
 	// Previous Template Definitions
 	template <typename...ComponentTypes>
 	ComponentPack<ComponentTypes...>::ComponentPack() {
 		AE_ASSERT(((std::is_base_of<Component, ComponentTypes>::value) && ...), "ComponentPack only accepts types inherited from ae::Component");
-		m_components = { typeid(ComponentTypes)... };
+		(m_components.set(internal::GetComponentTypeId<ComponentTypes>()), ...);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,320 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Component Query
+///
+///		Typed iteration over entities owning every component of the given types, created with EntityManager.Query<ComponentTypes...>().
+///		Exclude<ComponentTypes...>() skips entities owning any of the given component types.
+///		Each(operation) iterates through the smallest of the queried component storages and passes references to the components directly,
+///		the operation is a template parameter, so it can be inlined by the compiler (no std::function, no GetComponent lookups).
+///		The operation can take the entity as its first parameter: (Entity&, ComponentTypes&...) or only the components: (ComponentTypes&...).
+///		Querying a const component type passes a const reference, which marks read-only access.
+///		ParallelEach(operation, grain) splits the smallest storage into chunks of 'grain' components and processes them on JobPool's threads,
+///		the operation is called concurrently and structural changes are not allowed until it returns (see EntityManager.hpp).
+///		The same rules as for ViewComponents apply, killed entities are visited until Refresh, removing components while iterating is not allowed.
+/// 
+///		Queries do not record changes, mark modified components with Entity::MarkChanged<ComponentType>() (see change tracking in EntityManager.hpp).
+///		One of the following filters can be applied, the query then iterates only through the changes published by the last Refresh instead of a storage:
+///			Added<ComponentType>()   > entities which received a component of the type and still own it
+///			Changed<ComponentType>() > entities whose component of the type was changed and which still own it
+///			Removed<ComponentType>() > entities which lost a component of the type and are still alive without it (GetRemovedEntities<ComponentType>() lists removed entities as well)
+/// 
+///		Example:
+///			EntityManager.Query<Bounds, const Physics>().Exclude<Frozen>().Each([](Entity& entity, Bounds& bounds, const Physics& physics) { ... });
+///			EntityManager.Query<const Transform>().Changed<Transform>().Each([](Entity& entity, const Transform& transform) { ... });
+///			EntityManager.Query<Bounds>().Each([](Entity& entity, Bounds& bounds) { bounds.Move(offset); entity.MarkChanged<Bounds>(); });
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Utility.hpp"
+#include "Entity.hpp"
+#include "EntityManager.hpp"
+
+#include <array>
+#include <type_traits>
+
+namespace ae {
+	namespace internal {
+
+		template <typename ...ComponentTypes>
+		class ComponentQuery {
+			friend class EntityManagerType;
+
+			static_assert(sizeof...(ComponentTypes) > 0, "ComponentQuery requires at least one component type");
+			static_assert((std::is_base_of<Component, ComponentTypes>::value && ...), "ComponentTypes must inherit from ae::Component");
+
+		public:
+			template <typename ...ExcludeTypes>
+			ComponentQuery& Exclude();
+
+			template <typename ComponentType>
+			ComponentQuery& Added();
+			template <typename ComponentType>
+			ComponentQuery& Changed();
+			template <typename ComponentType>
+			ComponentQuery& Removed();
+
+			template <typename OperationType>
+			void Each(OperationType&& operation) const;
+
+			template <typename OperationType>
+			void ParallelEach(const OperationType& operation, size_t grain = 1024) const;
+
+		private:
+			enum class Filter {
+				None,
+				Added,
+				Changed,
+				Removed
+			};
+
+			ComponentSignature m_include, m_exclude;
+
+			Filter m_filter = Filter::None;
+			ComponentTypeId m_filter_type = 0;
+
+			ComponentQuery();
+
+			ComponentStorageBase* FindSmallestStorage() const;
+			const std::vector<EntityId>* FindFilteredEntities() const;
+
+			template <typename ComponentType>
+			ComponentQuery& SetFilter(Filter filter);
+
+			bool Matches(const Entity* entity) const;
+
+			template <typename OperationType>
+			void Visit(Entity* entity, OperationType& operation) const;
+
+			template <typename OperationType>
+			void EachInRange(const std::vector<Component*>& components, size_t begin, size_t end, OperationType& operation) const;
+			template <typename OperationType>
+			void EachInRange(const std::vector<EntityId>& entities, size_t begin, size_t end, OperationType& operation) const;
+
+			template <typename ComponentType>
+			static ComponentType& Fetch(const Entity* entity);
+		};
+
+		// Template Definitions
+
+		template <typename ...ComponentTypes>
+		ComponentQuery<ComponentTypes...>::ComponentQuery() {
+			(m_include.set(GetComponentTypeId<typename std::remove_const<ComponentTypes>::type>()), ...);
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename ...ExcludeTypes>
+		ComponentQuery<ComponentTypes...>& ComponentQuery<ComponentTypes...>::Exclude() {
+			(m_exclude.set(GetComponentTypeId<typename std::remove_const<ExcludeTypes>::type>()), ...);
+
+			AE_ASSERT((m_include & m_exclude).none(), "Could not query components, included and excluded components share at least one component type");
+
+			return *this;
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename ComponentType>
+		ComponentQuery<ComponentTypes...>& ComponentQuery<ComponentTypes...>::Added() {
+			return SetFilter<ComponentType>(Filter::Added);
+		}
+		template <typename ...ComponentTypes>
+		template <typename ComponentType>
+		ComponentQuery<ComponentTypes...>& ComponentQuery<ComponentTypes...>::Changed() {
+			return SetFilter<ComponentType>(Filter::Changed);
+		}
+		template <typename ...ComponentTypes>
+		template <typename ComponentType>
+		ComponentQuery<ComponentTypes...>& ComponentQuery<ComponentTypes...>::Removed() {
+			return SetFilter<ComponentType>(Filter::Removed);
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename ComponentType>
+		ComponentQuery<ComponentTypes...>& ComponentQuery<ComponentTypes...>::SetFilter(Filter filter) {
+
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not filter components, ComponentType must inherit from Component");
+			AE_ASSERT(m_filter == Filter::None, "Could not filter components, a query can use only one of Added, Changed and Removed filters");
+
+			m_filter = filter;
+			m_filter_type = GetComponentTypeId<typename std::remove_const<ComponentType>::type>();
+
+			return *this;
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename ComponentType>
+		ComponentType& ComponentQuery<ComponentTypes...>::Fetch(const Entity* entity) {
+			return *static_cast<ComponentType*>(entity->m_components[GetComponentTypeId<typename std::remove_const<ComponentType>::type>()]);
+		}
+
+		template <typename ...ComponentTypes>
+		const std::vector<EntityId>* ComponentQuery<ComponentTypes...>::FindFilteredEntities() const {
+
+			if (m_filter_type >= EntityManager.m_storages.size() || !EntityManager.m_storages[m_filter_type])
+				return nullptr;
+
+			ComponentStorageBase* storage = EntityManager.m_storages[m_filter_type];
+
+			switch (m_filter) {
+				case Filter::Added:   return &storage->added.previous;
+				case Filter::Changed: return &storage->changed.previous;
+				case Filter::Removed: return &storage->removed.previous;
+				default:              return nullptr;
+			}
+		}
+
+		template <typename ...ComponentTypes>
+		ComponentStorageBase* ComponentQuery<ComponentTypes...>::FindSmallestStorage() const {
+
+			// find storages, nothing to iterate if any of them does not exist
+			const std::array<ComponentStorageBase*, sizeof...(ComponentTypes)> storages = {
+				EntityManager.FindStorage<typename std::remove_const<ComponentTypes>::type>()...
+			};
+
+			ComponentStorageBase* smallest = nullptr;
+
+			for (ComponentStorageBase* storage : storages) {
+				if (!storage)
+					return nullptr;
+
+				if (!smallest || storage->components.size() < smallest->components.size())
+					smallest = storage;
+			}
+
+			return smallest;
+		}
+
+		template <typename ...ComponentTypes>
+		bool ComponentQuery<ComponentTypes...>::Matches(const Entity* entity) const {
+			return (entity->m_signature & m_include) == m_include && (entity->m_signature & m_exclude).none();
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename OperationType>
+		void ComponentQuery<ComponentTypes...>::Visit(Entity* entity, OperationType& operation) const {
+
+			if constexpr (std::is_invocable<OperationType&, Entity&, ComponentTypes&...>::value)
+				operation(*entity, Fetch<ComponentTypes>(entity)...);
+			else
+				operation(Fetch<ComponentTypes>(entity)...);
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename OperationType>
+		void ComponentQuery<ComponentTypes...>::EachInRange(const std::vector<Component*>& components, size_t begin, size_t end, OperationType& operation) const {
+
+			for (size_t i = begin; i < end; i++) {
+				Entity* entity = components[i]->GetEntity();
+
+				if (Matches(entity))
+					Visit(entity, operation);
+			}
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename OperationType>
+		void ComponentQuery<ComponentTypes...>::EachInRange(const std::vector<EntityId>& entities, size_t begin, size_t end, OperationType& operation) const {
+
+			for (size_t i = begin; i < end; i++) {
+				Entity* entity = EntityManager.GetEntity(entities[i]);
+
+				// removed since, or the component has been removed / added again
+				if (!entity || !Matches(entity) || (m_filter != Filter::Removed) != entity->m_signature.test(m_filter_type))
+					continue;
+
+				Visit(entity, operation);
+			}
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename OperationType>
+		void ComponentQuery<ComponentTypes...>::Each(OperationType&& operation) const {
+
+			// filtered - iterate through published changes
+			if (m_filter != Filter::None) {
+				const std::vector<EntityId>* entities = FindFilteredEntities();
+
+				if (entities)
+					EachInRange(*entities, 0, entities->size(), operation);
+
+				return;
+			}
+
+			ComponentStorageBase* smallest = FindSmallestStorage();
+			if (!smallest)
+				return;
+
+			// iterate
+			EachInRange(smallest->components, 0, smallest->components.size(), operation);
+		}
+
+		template <typename ...ComponentTypes>
+		template <typename OperationType>
+		void ComponentQuery<ComponentTypes...>::ParallelEach(const OperationType& operation, size_t grain) const {
+
+			// filtered - iterate through published changes
+			if (m_filter != Filter::None) {
+				const std::vector<EntityId>* entities = FindFilteredEntities();
+				if (!entities)
+					return;
+
+				EntityManagerType::ParallelIterationScope parallel_iteration(EntityManager);
+
+				JobPool.ParallelFor(entities->size(), grain, [this, &operation, entities](size_t begin, size_t end) {
+					EachInRange(*entities, begin, end, operation);
+				});
+
+				return;
+			}
+
+			ComponentStorageBase* smallest = FindSmallestStorage();
+			if (!smallest)
+				return;
+
+			// iterate in chunks of 'grain' components
+			const std::vector<Component*>& components = smallest->components;
+
+			EntityManagerType::ParallelIterationScope parallel_iteration(EntityManager);
+
+			JobPool.ParallelFor(components.size(), grain, [this, &operation, &components](size_t begin, size_t end) {
+				EachInRange(components, begin, end, operation);
+			});
+		}
+
+		template <typename ...ComponentTypes>
+		ComponentQuery<ComponentTypes...> EntityManagerType::Query() {
+			return ComponentQuery<ComponentTypes...>();
+		}
+	}
+}
@@ -0,0 +1,213 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Component Storage
+///
+///		Every component type owns a storage, in which its components live by value inside an ObjectPool.
+///		Pool chunks are never moved nor freed until the storage is destroyed, thus components keep stable addresses and can be referenced by pointers.
+///		Slots of removed components are reused by the next created component of the same type.
+/// 
+///		'components' is the dense vector used for iteration, it stores components in the order of their creation (or in the order of the last sort).
+///		Since consecutive components are placed next to each other inside chunks, iterating through it walks memory mostly linearly.
+///		Every component remembers its position in the dense vector, a component removed immediately is erased by swapping the last one into its place,
+///		entities removed by Refresh or Clear are erased by compacting the vector once, keeping the order.
+/// 
+///		Each storage records entities whose components were added, changed or removed. Changes are recorded into the current lists,
+///		EntityManager.Refresh swaps them with the previous ones, which are read by queries until the next Refresh.
+///		Every entity is recorded at most once per list and per Refresh, thanks to versions stored per entity slot.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Component.hpp"
+#include "ObjectPool.hpp"
+#include "Utility.hpp"
+
+#include <vector>
+#include <typeinfo>
+
+namespace ae {
+	namespace internal {
+
+		class ChangeList {
+		public:
+			std::vector<EntityId> current, previous;
+
+			void Record(EntityId entity, std::uint32_t version);
+			void Swap();
+
+		private:
+			struct Mark {
+				std::uint32_t version = 0;
+				std::uint32_t generation = 0;
+			};
+			std::vector<Mark> m_marks; // indexed by EntityId::index
+		};
+
+		class ComponentStorageBase {
+		public:
+			virtual ~ComponentStorageBase() = default;
+
+			// destroys the component and releases its slot, does not touch the dense vector
+			virtual void Destroy(Component* component) = 0;
+
+			// destroys all components, keeps the memory
+			virtual void Clear() = 0;
+
+			virtual void Reserve(size_t count) = 0;
+			virtual PoolMemoryStats GetMemoryStats() const = 0;
+
+			virtual const char* GetTypeName() const = 0;
+			virtual size_t GetComponentSize() const = 0;
+
+			std::vector<Component*> components;
+
+			// dense vector with positions remembered by components
+			void Insert(Component* component);
+			void Erase(Component* component); // swaps the last component into its place
+			void UpdatePositions(); // has to be called after components were reordered
+
+			// change tracking
+			ChangeList added, changed, removed;
+			std::uint32_t version = 1; // increased by every swap
+
+			void RecordAdded(EntityId entity) { added.Record(entity, version); }
+			void RecordChanged(EntityId entity) { changed.Record(entity, version); }
+			void RecordRemoved(EntityId entity) { removed.Record(entity, version); }
+			void SwapChanges();
+
+		protected:
+			ComponentStorageBase() = default;
+			ComponentStorageBase(const ComponentStorageBase&) = delete;
+			ComponentStorageBase(ComponentStorageBase&&) = delete;
+		};
+
+		inline void ChangeList::Record(EntityId entity, std::uint32_t version) {
+			if (m_marks.size() <= entity.index)
+				m_marks.resize(entity.index + 1);
+
+			// already recorded
+			Mark& mark = m_marks[entity.index];
+
+			if (mark.version == version && mark.generation == entity.generation)
+				return;
+
+			mark.version = version;
+			mark.generation = entity.generation;
+			current.push_back(entity);
+		}
+		inline void ChangeList::Swap() {
+			previous.swap(current);
+			current.clear();
+		}
+
+		inline void ComponentStorageBase::Insert(Component* component) {
+			component->m_storage_position = static_cast<std::uint32_t>(components.size());
+			components.push_back(component);
+		}
+		inline void ComponentStorageBase::Erase(Component* component) {
+			Component* last = components.back();
+
+			components[component->m_storage_position] = last;
+			last->m_storage_position = component->m_storage_position;
+			components.pop_back();
+		}
+		inline void ComponentStorageBase::UpdatePositions() {
+			for (size_t i = 0; i < components.size(); i++)
+				components[i]->m_storage_position = static_cast<std::uint32_t>(i);
+		}
+
+		inline void ComponentStorageBase::SwapChanges() {
+			added.Swap();
+			changed.Swap();
+			removed.Swap();
+			version++;
+		}
+
+		template <typename ComponentType>
+		class ComponentStorage : public ComponentStorageBase {
+		public:
+			ComponentStorage() = default;
+			~ComponentStorage();
+
+			template <typename ...ArgsType>
+			ComponentType* Create(ArgsType&&... args);
+			virtual void Destroy(Component* component) override;
+			virtual void Clear() override;
+
+			virtual void Reserve(size_t count) override;
+			virtual PoolMemoryStats GetMemoryStats() const override { return m_pool.GetMemoryStats(); }
+
+			virtual const char* GetTypeName() const override { return typeid(ComponentType).name(); }
+			virtual size_t GetComponentSize() const override { return sizeof(ComponentType); }
+
+		private:
+			ObjectPool<ComponentType> m_pool;
+		};
+
+		// Template Definitions
+
+		template <typename ComponentType>
+		ComponentStorage<ComponentType>::~ComponentStorage() {
+			for (Component* component : components)
+				static_cast<ComponentType*>(component)->~ComponentType();
+		}
+
+		template <typename ComponentType>
+		template <typename ...ArgsType>
+		ComponentType* ComponentStorage<ComponentType>::Create(ArgsType&&... args) {
+			return m_pool.Create(std::forward<ArgsType>(args)...);
+		}
+
+		template <typename ComponentType>
+		void ComponentStorage<ComponentType>::Destroy(Component* component) {
+			m_pool.Destroy(static_cast<ComponentType*>(component));
+		}
+
+		template <typename ComponentType>
+		void ComponentStorage<ComponentType>::Clear() {
+			for (Component* component : components)
+				static_cast<ComponentType*>(component)->~ComponentType();
+
+			// all slots are free, refilled storages walk memory linearly again
+			components.clear();
+			m_pool.ReleaseAll();
+		}
+
+		template <typename ComponentType>
+		void ComponentStorage<ComponentType>::Reserve(size_t count) {
+			m_pool.Reserve(count);
+			components.reserve(count);
+		}
+	}
+}
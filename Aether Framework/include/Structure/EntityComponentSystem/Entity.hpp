@@ -35,14 +35,22 @@
 #include "../../Core/Preprocessor.hpp"
 
 #include "Utility.hpp"
+#include "GroupSet.hpp"
 #include "EntityManager.hpp"
 
 #include <vector>
+#include <utility>
 
 namespace ae {
 
 	namespace internal {
 		class EntityManagerType;
+
+		template <typename ...ComponentTypes>
+		class ComponentQuery;
+
+		template <typename ObjectType>
+		class ObjectPool;
 	}
 	class Component;
 
@@ -50,6 +58,12 @@ namespace ae {
 	class Entity {
 		friend class internal::EntityManagerType;
 
+		template <typename ...ComponentTypes>
+		friend class internal::ComponentQuery;
+
+		template <typename ObjectType>
+		friend class internal::ObjectPool;
+
 	public:
 		~Entity() = default;
 
@@ -65,6 +79,10 @@ namespace ae {
 		template <typename ComponentType>
 		ComponentType& GetComponent() const;
 
+		// records the component as changed, queries with Changed<ComponentType>() filter visit it after the next Refresh
+		template <typename ComponentType>
+		void MarkChanged();
+
 		void AddToGroup(EntityGroup group);
 		void RemoveFromGroup(EntityGroup group);
 
@@ -78,15 +96,30 @@ namespace ae {
 		void Kill() { m_alive = false; }
 		bool IsAlive() { return m_alive; }
 
+		EntityId GetId() const { return m_id; }
+
 	private:
-		std::vector<Component*> m_components;
-		std::vector<EntityGroup> m_groups; // does not store AllEntitiesGroup
+		EntityId m_id;
+		std::vector<Component*> m_components; // indexed by ComponentTypeId, nullptr if entity has no such component
+		internal::ComponentSignature m_signature;
+		internal::GroupSet m_groups; // does not store AllEntitiesGroup
+		std::vector<std::pair<EntityGroup, std::uint32_t>> m_group_positions; // position in each group's vector, entities belong to few groups
 
 		bool m_alive = true;
+		bool m_marked_for_removal = false;
 
 		Entity() = default;
 		Entity(const Entity&) = delete;
 		Entity(Entity&&) = delete;
+
+		// do not update advanced views
+		void AttachComponent(internal::ComponentTypeId id, Component* component);
+		void DetachComponent(internal::ComponentTypeId id);
+		void AttachGroup(EntityGroup group);
+		void DetachGroup(EntityGroup group);
+
+		std::uint32_t& GetGroupPosition(EntityGroup group);
+		void EraseGroupPosition(EntityGroup group);
 	};
 
 	// Template Definitions
@@ -96,14 +129,12 @@ namespace ae {
 
 		AE_ASSERT(!HasComponent<ComponentType>(), "Entity already has '" << typeid(ComponentType).name() << "' component");
 
-		ComponentType* comp = new ComponentType(std::forward<ArgsType>(args)...);
-		comp->m_entity = this;
-		comp->Initialize();
+		const internal::ComponentTypeId id = internal::GetComponentTypeId<ComponentType>();
 
-		EntityManager.PushComponent(comp);
-		EntityManager.UpdateViews(this, m_components, comp, true);
+		ComponentType* comp = EntityManager.CreateComponent<ComponentType>(std::forward<ArgsType>(args)...);
+		AttachComponent(id, comp);
 
-		m_components.push_back(comp);
+		EntityManager.UpdateComponentViews(this, internal::ComponentSignature().set(id));
 
 		return *comp;
 	}
@@ -112,22 +143,14 @@ namespace ae {
 	void Entity::RemoveComponent() {
 
 		AE_ASSERT(HasComponent<ComponentType>(), "Entity does not have '" << typeid(ComponentType).name() << "' component");
+		AE_ASSERT(!EntityManager.IsIteratingInParallel(), "Could not remove component, structural changes are not allowed during parallel iteration");
 
-		// find & remove component from entity
-		Component* comp = nullptr;
-
-		// find 
-		auto comp_it = std::find_if(m_components.begin(), m_components.end(),
-			[](Component* comp) {
-				return (typeid(*comp) == typeid(ComponentType));
-		});
+		const internal::ComponentTypeId id = internal::GetComponentTypeId<ComponentType>();
 
-		// remove from manager
-		EntityManager.UpdateViews(this, m_components, *comp_it, false);
-		EntityManager.EraseComponent(*comp_it);
+		// remove from manager & entity
+		DetachComponent(id);
 
-		// erase from entity
-		m_components.erase(comp_it);
+		EntityManager.UpdateComponentViews(this, internal::ComponentSignature().set(id));
 	}
 
 	template <typename ComponentType>
@@ -135,11 +158,7 @@ namespace ae {
 
 		AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "ComponentType must inherit from ae::Component, '" << typeid(ComponentType).name() <<"' does not");
 
-		for (auto it(m_components.begin()); it != m_components.end(); it++)
-			if (typeid(**it) == typeid(ComponentType))
-				return true;
-
-		return false;
+		return m_signature.test(internal::GetComponentTypeId<ComponentType>());
 	}
 
 	template <typename ComponentType>
@@ -147,11 +166,14 @@ namespace ae {
 
 		AE_ASSERT(HasComponent<ComponentType>(), "Entity does not have '" << typeid(ComponentType).name() << "' component");
 
-		for (auto it(m_components.begin()); it != m_components.end(); it++)
-			if (typeid(**it) == typeid(ComponentType))
-				return *static_cast<ComponentType*>(*it);
+		return *static_cast<ComponentType*>(m_components[internal::GetComponentTypeId<ComponentType>()]);
+	}
+
+	template <typename ComponentType>
+	void Entity::MarkChanged() {
+
+		AE_ASSERT(HasComponent<ComponentType>(), "Entity does not have '" << typeid(ComponentType).name() << "' component");
 
-		// crash
-		LogError("[Aether] Error while trying to return component '" + std::string(typeid(ComponentType).name()) + "', it does not belong to entity", true);
+		EntityManager.m_storages[internal::GetComponentTypeId<ComponentType>()]->RecordChanged(m_id);
 	}
 }
\ No newline at end of file
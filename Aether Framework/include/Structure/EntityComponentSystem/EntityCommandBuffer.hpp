@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Entity Command Buffer
+///
+///		Records structural changes (creating and killing entities, adding and removing components and groups) to be applied later,
+///		it can be used from any thread, including from inside parallel views and systems running in parallel.
+///		EntityManager owns one buffer (EntityManager.GetCommandBuffer()), which is played back at the beginning of EntityManager.Refresh.
+/// 
+///		Playback creates requested entities first, then sorts the remaining commands by entity (keeping the order of recording)
+///		and applies all commands of an entity at once, updating advanced views once per entity.
+///		Commands targeting entities that no longer exist are dropped.
+/// 
+///		CreateEntity returns a pending handle, which can only be used to record further commands until the buffer is played back,
+///		commands recorded later with a pending handle of an earlier playback are dropped.
+///		Arguments of AddComponent are copied and the component is constructed during playback.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Utility.hpp"
+
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+
+namespace ae {
+	class Component;
+
+	namespace internal {
+		class EntityManagerType;
+	}
+
+	class EntityCommandBuffer {
+		friend class internal::EntityManagerType;
+
+	public:
+		EntityCommandBuffer() = default;
+		EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+		EntityCommandBuffer(EntityCommandBuffer&&) = delete;
+
+		EntityId CreateEntity();
+		void Kill(EntityId entity);
+
+		// defined in EntityManager.hpp
+		template <typename ComponentType, typename ...ArgsType>
+		void AddComponent(EntityId entity, ArgsType&&... args);
+
+		template <typename ComponentType>
+		void RemoveComponent(EntityId entity);
+
+		void AddToGroup(EntityId entity, EntityGroup group);
+		void RemoveFromGroup(EntityId entity, EntityGroup group);
+
+		size_t GetSize() const;
+
+	private:
+		enum class CommandType {
+			CreateEntity,
+			Kill,
+			AddComponent,
+			RemoveComponent,
+			AddToGroup,
+			RemoveFromGroup
+		};
+
+		struct Command {
+			CommandType type;
+			EntityId entity;
+			internal::ComponentTypeId component = 0;
+			EntityGroup group = AllEntitiesGroup;
+			std::function<Component*(internal::EntityManagerType&)> create;
+		};
+
+		static constexpr std::uint32_t c_pending_generation = 0xFFFFFFFF;
+
+		mutable std::mutex m_mutex;
+		std::vector<Command> m_commands;
+
+		// pending handles are numbered continuously across playbacks, thus handles of earlier playbacks precede m_first_pending
+		std::uint32_t m_first_pending = 0;
+		std::uint32_t m_next_pending = 0;
+
+		void Record(Command&& command);
+		void Take(std::vector<Command>& commands, std::uint32_t& first_pending);
+
+		static bool IsPending(EntityId entity) { return entity.generation == c_pending_generation; }
+	};
+
+	// Template Definitions
+
+	template <typename ComponentType>
+	void EntityCommandBuffer::RemoveComponent(EntityId entity) {
+		Command command;
+		command.type = CommandType::RemoveComponent;
+		command.entity = entity;
+		command.component = internal::GetComponentTypeId<ComponentType>();
+		Record(std::move(command));
+	}
+}
@@ -36,6 +36,10 @@
 /// General ideas:
 /// 
 ///		EntityManager stores and manages all entiites and components.
+///		Components of the same type are stored by value in contiguous, chunked storages (see ComponentStorage.hpp), their addresses never change.
+///		Every component type receives a dense id on its first use and each entity keeps a bitset signature of its component types,
+///		thus HasComponent is a single bit test and GetComponent is an indexed lookup.
+///		There can be at most AE_ECS_MAX_COMPONENT_TYPES (default 64) component types, the macro has to be defined equally for the framework and the application.
 ///		Each entity can be assigned only one component of a type.
 ///		All components must publicly inherit from Component.
 ///		All components retrieve their entity pointers after the constructor runs, thus in order to use them during component initialization, override Initialize function
@@ -44,10 +48,27 @@
 ///		Each entity that has been killed will be optainable through Viewing (Entity::IsAlive() can be used) until it is removed when Refresh function is called, which happens every application loop iteration, 
 ///		but can also be called any time. To disable this initialize the application with 'ecs_refresh_entities_each_tick' framework setting set to false.
 /// 
+/// Entity handles:
+///		Each entity owns a generational EntityId (Entity::GetId()), which can be stored instead of Entity pointers.
+///		GetEntity(id) returns the entity or nullptr if it has already been removed, IsValid(id) checks that in O(1).
+///		Slots of removed entities are reused, but their generation is increased, so old handles never point to new entities.
+///		Killed entities stay valid until they are removed by Refresh.
+///		Refresh and Clear keep the order of component storages and groups (AllEntitiesGroup included), they compact the affected vectors once.
+///		Immediate removals (RemoveAliveEntity, Entity::RemoveComponent and removing an entity from a group) do not keep it:
+///		components and entities of groups remember their positions in their vectors, so they swap the last element
+///		of each affected vector into the removed one's place, without searching the vectors.
+/// 
+/// Memory:
+///		Entities and components are allocated from chunked pools (see ObjectPool.hpp), memory of removed ones is reused and never returned
+///		to the global allocator before EntityManager is destroyed, clearing included. Removed entities are recycled together with their internal vectors,
+///		thus once the pools have grown, spawning and removing entities does not allocate.
+///		Reserve<ComponentType>(count) and ReserveEntities(count) grow the pools up front, GetMemoryStats<ComponentType>() and GetEntityMemoryStats() report their usage.
+/// 
 /// Iterating through entities:
 /// 
 ///		ViewComponent and ViewEntities are used to iterate through EntityManager's assets.
-///		An empty storage is removed as soon as the last entity/component is removed from it.
+///		Entity storages of groups keep their memory for the next entities of the group when they become empty, even when cleared,
+///		component storages keep their memory for the next components of the same type until EntityManager is destroyed.
 ///		Entities can be easily killed while viewing as they are removed every time Refresh function is called (defaultly every tick),
 ///		but removing them via RemoveAliveEntity can unleash undefined behaviour. This also applies to removing components while iterating through their type.
 ///		
@@ -58,10 +79,41 @@
 ///			> iterates through entities of a group, where group AllEntitiesGroup (index 0) stores all entities.
 ///			> iterates over advanced views (storages containing entities tagged by either (multiple groups and/or exclude groups) or (multiple components and/or exclude components)).
 ///		
+///			Advanced views are kept up to date incrementally, a structural change (adding or removing a component / group) only visits views whose tags mention the changed component type or group,
+///			removing an entity only visits views which include one of its groups or component types, or include none.
+///			Entities are erased from advanced views by swapping the last entity into their place, which does not preserve the order of a view (for example after sorting it),
+///			initialize the application with 'ecs_preserve_view_order' framework setting set to true to shift the following entities instead.
+///			The setting only concerns advanced views, ViewComponents and ViewEntities of a group keep their order after Refresh and Clear without it,
+///			but lose it on immediate removals even with it (see Entity handles above).
+///		
 ///			If a tag does not exist EntityManager tries to create it's storage (advanced view) by iterating through all entities and checking if any belongs to it,
 ///			if no such entity was found, storage is not created. Thus viewing empty (same thing applies to sorting but NOT to clearing) advanced views can be resource-consuming, 
 ///			in order to control registering and unregistering advanced views manually initialize the application with 'ecs_manage_advanced_views_manually' framework setting set to true,
 ///			that also makes clearing EntityManager or it's storages not to remove advanced entity storages.
+///			
+///			Every advanced view keeps being updated by structural changes after it has been used once, even if it is never used again.
+///			'ecs_advanced_view_max_age' and 'ecs_max_advanced_views' framework settings make Refresh unregister views unused for a number of Refresh calls
+///			or the least recently used views above a limit, a view used again is registered again. Iterators of an unregistered view become invalid.
+/// 
+///		Query
+///			> EntityManager.Query<ComponentTypes...>().Exclude<ComponentTypes...>().Each(operation) iterates through entities owning all given components
+///			  and passes the components directly to the operation, without creating an advanced view (see ComponentQuery.hpp).
+/// 
+///		ParallelViewComponents / ComponentQuery::ParallelEach
+///			> split components into chunks of 'grain' elements and process them on JobPool's threads (see JobPool.hpp), chunking does not depend on the number of threads.
+///			> the operation is called concurrently, it can modify the components it receives and kill entities, 
+///			  but structural changes (creating / removing entities, adding / removing components and groups, clearing, refreshing) are not allowed until it returns,
+///			  debug builds reject them.
+///			> advanced views can be iterated, but not registered, unregistered nor sorted during parallel iteration (debug builds reject that as well),
+///			  thus views used concurrently have to be registered beforehand (RegisterAdvancedView, or a view call made outside of parallel iteration).
+/// 
+///		Prefabs
+///			> EntityManager.CreateEntities(count, prefab) creates a batch of entities sharing components and groups described by a Prefab (see Prefab.hpp)
+///			  and returns their handles, advanced views are updated once for the whole batch.
+/// 
+///		Command buffer
+///			> structural changes which cannot be made immediately (while iterating, from other threads) can be recorded in EntityManager.GetCommandBuffer(),
+///			  it is played back at the beginning of Refresh (see EntityCommandBuffer.hpp).
 /// 
 ///		GetBeginEndIterators
 ///			Another way is to retrieve raw iterators, GetBeginEndIterators return pair of iterators to the vector of entities/components.
@@ -71,11 +123,15 @@
 /// 
 ///	Clearing
 ///		Clear functions instantly erase all suitable entities. 
+///		Removed entities (cleared or killed and refreshed) are marked first and then erased together,
+///		every affected storage and group is compacted in a single pass, keeping the order of the remaining elements.
 ///		If clearing an advanced view that has not been registered yet,
 ///		EntityManager will iterate through all entities instead without registering it.
 ///
 /// Sorting:
 ///		Sorts entities/components using std::sort function.
+///		SortViewByKey extracts a float or integer key of every entity/component once and sorts them using stable radix sort (see RadixSort.hpp),
+///		which is faster than comparing elements when sorting many of them, for example by depth, every frame.
 ///		If sorting an advanced view that has not been registered yet,
 ///		EntityManager will try to register it.
 /// 
@@ -84,21 +140,51 @@
 ///		If counting entities from an advanced view that has not been registered yet,
 ///		EntityManager will try to register it.
 /// 
+/// Change tracking:
+///		Every component storage records entities whose components were added, changed or removed, without scanning the components.
+///		A component is changed when it is marked by Entity::MarkChanged<ComponentType>(), queries, ViewComponents, GetComponent and iterators do not record changes,
+///		so iterating through the changed entities does not mark them again. Refresh publishes changes recorded since the previous Refresh,
+///		they are read by GetAddedEntities / GetChangedEntities / GetRemovedEntities<ComponentType>() and by Added / Changed / Removed query filters (see ComponentQuery.hpp).
+///		Thus every change is seen exactly once, during the tick following the Refresh. Changes of one component type must not be recorded from multiple threads at once,
+///		systems declaring Writes<ComponentType> satisfy that, ParallelEach operations must not mark changes.
+/// 
+///		A SpatialIndex can be kept up to date from changes of a bounds component (see SpatialGrid.hpp).
+/// 
+/// Transforms:
+///		TransformComponent and TransformHierarchy combine local transforms of entities with those of their parents (see TransformHierarchy.hpp).
+/// 
+/// Statistics:
+///		GetStats() reports entities, component types, advanced views, allocations and the cost of Refresh (see Statistics.hpp),
+///		CountAdvancedViews() returns only the number of registered advanced views.
+/// 
+/// Snapshots:
+///		SaveSnapshot and LoadSnapshot store and restore entities, groups and components of registered types in a binary file (see Snapshot.hpp).
+/// 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #pragma once
 
 #include "../../Core/CreateStructure.hpp"
 #include "../../Core/Preprocessor.hpp"
+#include "../../Core/RadixSort.hpp"
+#include "../JobPool.hpp"
 
 #include "Utility.hpp"
 #include "ComponentPack.hpp"
+#include "ComponentStorage.hpp"
+#include "ObjectPool.hpp"
 #include "ViewTag.hpp"
+#include "EntityView.hpp"
+#include "EntityCommandBuffer.hpp"
+#include "Prefab.hpp"
+#include "Statistics.hpp"
 
 #include <vector>
 #include <unordered_map>
 #include <functional>
 #include <algorithm>
+#include <tuple>
+#include <string>
 
 namespace ae {
 	
@@ -107,20 +193,47 @@ namespace ae {
 
 	namespace internal {
 
+		template <typename ...ComponentTypes>
+		class ComponentQuery;
+
+		class SystemSchedulerType;
+		class EntityManagerType;
+
+		// function constructing a component from copies of the arguments, used by EntityCommandBuffer and Prefab
+		template <typename ComponentType, bool single_use, typename ...ArgsType>
+		std::function<Component*(EntityManagerType&)> MakeComponentFactory(ArgsType&&... args);
+
 		class EntityManagerType {
 			template <typename SingletonType>
 			friend SingletonType ae::internal::CreateStructure<EntityManagerType>();
 
-			friend class Entity;
+			friend class ae::Entity;
+			friend class ae::EntityCommandBuffer;
+			friend class ae::Prefab;
+
+			template <typename ...ComponentTypes>
+			friend class ComponentQuery;
+
+			friend class SystemSchedulerType;
+
+			template <typename ComponentType, bool single_use, typename ...ArgsType>
+			friend std::function<Component*(EntityManagerType&)> MakeComponentFactory(ArgsType&&... args);
 
 		public:
-			~EntityManagerType() { Clear(); }
+			~EntityManagerType();
 
 			Entity& CreateEntity();
+			std::vector<EntityId> CreateEntities(size_t count, const Prefab& prefab);
 			EntityGroup CreateGroup();
 			void RemoveAliveEntity(Entity& entity);
+			void RemoveAliveEntity(EntityId id);
 			void Refresh();
 
+			Entity* GetEntity(EntityId id) const;
+			bool IsValid(EntityId id) const;
+
+			EntityCommandBuffer& GetCommandBuffer() { return m_command_buffer; }
+
 			template <typename ComponentType>
 			void Clear();
 			void Clear(EntityGroup group = AllEntitiesGroup);
@@ -129,10 +242,16 @@ namespace ae {
 
 			template <typename ComponentType>
 			void ViewComponents(const std::function<void(ComponentType&)>& operation);
+			template <typename ComponentType>
+			void ParallelViewComponents(const std::function<void(ComponentType&)>& operation, size_t grain = 1024);
 			void ViewEntities(const std::function<void(Entity&)>& operation, EntityGroup group = AllEntitiesGroup);
 			void ViewEntities(const std::function<void(Entity&)>& operation, const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups = {});
 			void ViewEntities(const std::function<void(Entity&)>& operation, const ComponentPack<>& components, const ComponentPack<>& exclude_components = {});
 
+			// defined in ComponentQuery.hpp
+			template <typename ...ComponentTypes>
+			ComponentQuery<ComponentTypes...> Query();
+
 			void RegisterAdvancedView(const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups = {});
 			void RegisterAdvancedView(const ComponentPack<>& components, const ComponentPack<>& exclude_components = {});
 
@@ -145,6 +264,16 @@ namespace ae {
 			void SortView(const std::function<bool(Entity&, Entity&)>& compare, EntityGroup group = AllEntitiesGroup);
 			void SortView(const std::function<bool(Entity&, Entity&)>& compare, const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups = {});
 			void SortView(const std::function<bool(Entity&, Entity&)>& compare, const ComponentPack<>& components, const ComponentPack<>& exclude_components = {});
+
+			// KeyFunctionType returns a float or an integer key of a component / an entity, sorts in ascending order of keys, keeps the order of equal keys
+			template <typename ComponentType, typename KeyFunctionType>
+			void SortViewByKey(const KeyFunctionType& key);
+			template <typename KeyFunctionType>
+			void SortViewByKey(const KeyFunctionType& key, EntityGroup group = AllEntitiesGroup);
+			template <typename KeyFunctionType>
+			void SortViewByKey(const KeyFunctionType& key, const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups = {});
+			template <typename KeyFunctionType>
+			void SortViewByKey(const KeyFunctionType& key, const ComponentPack<>& components, const ComponentPack<>& exclude_components = {});
 			
 			template <typename ComponentType>
 			std::pair<std::vector<Component*>::iterator, std::vector<Component*>::iterator> GetBeginEndIterators();
@@ -160,47 +289,194 @@ namespace ae {
 			size_t CountEntities(const ComponentPack<>& components, const ComponentPack<>& exclude_components = {});
 			size_t CountAdvancedViews() const;
 
+			// entities whose components of a type were added / changed / removed between the last two Refresh calls
+			template <typename ComponentType>
+			const std::vector<EntityId>& GetAddedEntities() const;
+			template <typename ComponentType>
+			const std::vector<EntityId>& GetChangedEntities() const;
+			template <typename ComponentType>
+			const std::vector<EntityId>& GetRemovedEntities() const;
+			// increases with every Refresh, 0 if no component of a type has been created yet
+			template <typename ComponentType>
+			std::uint32_t GetChangeVersion() const;
+
+			template <typename ComponentType>
+			void Reserve(size_t count);
+			void ReserveEntities(size_t count);
+
+			template <typename ComponentType>
+			PoolMemoryStats GetMemoryStats() const;
+			PoolMemoryStats GetEntityMemoryStats() const;
+
+			EntityManagerStats GetStats() const;
+			void GetStats(EntityManagerStats& stats) const;
+			const RefreshStats& GetRefreshStats() const { return m_refresh_stats; }
+
+			// defined in Snapshot.hpp
+			template <typename ComponentType>
+			void RegisterSnapshotComponent(const std::string& name);
+			template <typename ComponentType>
+			void RegisterSnapshotComponent(
+				const std::string& name, 
+				const std::function<void(const ComponentType&, std::vector<std::uint8_t>&)>& save, 
+				const std::function<void(Entity&, const std::uint8_t*, size_t)>& load
+			);
+
+			bool SaveSnapshot(const std::string& filename) const;
+			bool LoadSnapshot(const std::string& filename);
+
+			bool IsIteratingInParallel() const { return m_parallel_iterations > 0; }
+
 		private:
-			std::unordered_map<ComponentTypeId, std::vector<Component*>> m_components;
+			std::vector<ComponentStorageBase*> m_storages; // indexed by ComponentTypeId, nullptr if no component of a type has been created yet
 			std::unordered_map<EntityGroup, std::vector<Entity*>> m_entities;
-			std::unordered_map<GroupTag, std::vector<Entity*>, GroupTag::Hash> m_group_views;
-			std::unordered_map<ComponentTag, std::vector<Entity*>, ComponentTag::Hash> m_component_views;
+			std::unordered_map<GroupTag, EntityView, GroupTag::Hash> m_group_views;
+			std::unordered_map<ComponentTag, EntityView, ComponentTag::Hash> m_component_views;
+
+			// advanced views mentioning a group / component type (in either include or exclude set)
+			typedef decltype(m_group_views)::value_type GroupView;
+			typedef decltype(m_component_views)::value_type ComponentView;
+
+			std::unordered_map<EntityGroup, std::vector<GroupView*>> m_group_view_index;
+			std::vector<std::vector<ComponentView*>> m_component_view_index; // indexed by ComponentTypeId
+
+			// advanced views by the first group / component type they include, an entity can belong only to views indexed by its own groups and components,
+			// group views including no group are indexed by AllEntitiesGroup, component views including no component type are kept separately
+			std::unordered_map<EntityGroup, std::vector<GroupView*>> m_group_view_owners;
+			std::vector<std::vector<ComponentView*>> m_component_view_owners; // indexed by ComponentTypeId
+			std::vector<ComponentView*> m_excluding_component_views;
 
 			EntityGroup m_next_group = AllEntitiesGroup;
 
-			EntityManagerType() = default;
+			std::atomic<unsigned int> m_parallel_iterations = 0;
+
+			// counts a parallel iteration for its lifetime, so that the count is restored even if an exception propagates
+			class ParallelIterationScope {
+			public:
+				explicit ParallelIterationScope(EntityManagerType& manager) : m_manager(manager) { m_manager.m_parallel_iterations++; }
+				~ParallelIterationScope() { m_manager.m_parallel_iterations--; }
+
+				ParallelIterationScope(const ParallelIterationScope&) = delete;
+				ParallelIterationScope& operator=(const ParallelIterationScope&) = delete;
+
+			private:
+				EntityManagerType& m_manager;
+			};
+
+			EntityCommandBuffer m_command_buffer;
+			std::vector<EntityCommandBuffer::Command> m_played_commands; // kept to reuse memory
+			std::vector<Entity*> m_created_entities; // batch of CreateEntities, kept to reuse memory
+
+			// slot map of entity handles
+			struct EntitySlot {
+				Entity* entity = nullptr;
+				std::uint32_t generation = 0;
+				std::uint32_t position = 0; // index in AllEntitiesGroup
+			};
+			std::vector<EntitySlot> m_entity_slots;
+			std::vector<std::uint32_t> m_free_entity_slots;
+
+			// removed entities stay constructed, so that their vectors keep their memory
+			ObjectPool<Entity> m_entity_pool;
+			std::vector<Entity*> m_recycled_entities;
+
+			// component types registered for snapshots
+			struct SnapshotComponent {
+				std::string name;
+				ComponentTypeId id = 0;
+				size_t record_size = 0; // size of SnapshotData, 0 if saved with custom functions
+				ComponentStorageBase* (*find_or_create_storage)(EntityManagerType&) = nullptr;
+				std::function<void(const Component&, std::vector<std::uint8_t>&)> save;
+				std::function<void(EntityManagerType&, Entity&, const std::uint8_t*, size_t)> load; // size-prefixed data
+
+				// fixed size records, all components of a section at once (entities by index, indices, records, count)
+				void (*load_records)(EntityManagerType&, const std::vector<Entity*>&, const std::uint8_t*, const std::uint8_t*, size_t) = nullptr;
+			};
+			std::vector<SnapshotComponent> m_snapshot_components;
+
+			// statistics, rebuild counts of evicted views are remembered until their views are rebuilt,
+			// above c_evicted_view_history tags per view type the remembered ones are forgotten in no particular order
+			static constexpr size_t c_evicted_view_history = 256;
+
+			RefreshStats m_refresh_stats;
+			size_t m_view_rebuild_count = 0;
+			size_t m_failed_view_registration_count = 0;
+			size_t m_view_eviction_count = 0;
+			size_t m_evicted_view_rebuild_count = 0;
+			std::unordered_map<GroupTag, size_t, GroupTag::Hash> m_evicted_group_views;
+			std::unordered_map<ComponentTag, size_t, ComponentTag::Hash> m_evicted_component_views;
+
+			EntityManagerType();
 			EntityManagerType(const EntityManagerType&) = delete;
 			EntityManagerType(EntityManagerType&&) = delete;
 
 			void ClearAll();
 
-			void PushComponent(Component* component);
-			void EraseComponent(Component* component);
+			Entity* AcquireEntity();
+			void RegisterEntity(Entity* entity);
+			void UnregisterEntity(Entity* entity);
+			void DestroyEntity(Entity* entity);
+
+			void RemoveMarkedEntities(size_t marked_count);
+
+			template <typename ComponentType>
+			ComponentStorage<ComponentType>* FindStorage() const;
+			template <typename ElementType, typename KeyFunctionType>
+			static void SortByKey(std::vector<ElementType*>& elements, const KeyFunctionType& key);
+			template <typename ComponentType>
+			ComponentStorage<ComponentType>* FindOrCreateStorage();
+			template <typename ComponentType>
+			const std::vector<EntityId>& GetChanges(ChangeList ComponentStorageBase::* list) const;
+			template <typename ComponentType, typename ...ArgsType>
+			ComponentType* CreateComponent(ArgsType&&... args);
+			void EraseComponent(ComponentTypeId id, Component* component);
+			void EraseComponents(Entity* entity);
 
 			void RegisterEntityToGroup(EntityGroup group, Entity* entity);
 			void UnregisterEntityFromGroup(EntityGroup group, Entity* entity);
+
+			// entities remember their positions in groups' vectors, AllEntitiesGroup positions are kept by entity slots
+			static void InsertToGroup(std::vector<Entity*>& entities, EntityGroup group, Entity* entity);
+			void UpdateGroupPositions(EntityGroup group, const std::vector<Entity*>& entities);
 			
 			// Advanced Views
-			decltype(m_group_views)::iterator RegisterView(GroupTag&& tag);
-			decltype(m_component_views)::iterator RegisterView(ComponentTag&& tag);
+			decltype(m_group_views)::iterator RegisterView(GroupTag&& tag, bool allow_empty = false);
+			decltype(m_component_views)::iterator RegisterView(ComponentTag&& tag, bool allow_empty = false);
 
 			decltype(m_component_views)::iterator FindOrRegisterView(ComponentTag&& tag);
 			decltype(m_group_views)::iterator FindOrRegisterView(GroupTag&& tag);
 
-			void UpdateViews(Entity* entity, const std::vector<EntityGroup>& old_groups, const std::vector<EntityGroup>& add_groups, const std::vector<EntityGroup>& remove_groups);
-			void UpdateViews(Entity* entity, const std::vector<Component*>& old_components, Component* component, bool add_or_remove);
+			void IndexView(GroupView& view);
+			void IndexView(ComponentView& view);
 
-			void UpdateComponentViewsOnEntityRemoval(Entity* killed_entity);
-			void UpdateComponentViewsOnEntityRemoval(Entity* killed_entity, const ComponentTag& ignore_tag);
+			void UnindexView(GroupView& view);
+			void UnindexView(ComponentView& view);
+
+			// entity must already store its new groups / components
+			void UpdateGroupViews(Entity* entity, const EntityGroup* changed_groups, size_t changed_count);
+			void UpdateGroupViews(Entity* entity, const std::vector<EntityGroup>& changed_groups) { UpdateGroupViews(entity, changed_groups.data(), changed_groups.size()); }
+			void UpdateGroupViews(Entity* entity, EntityGroup changed_group) { UpdateGroupViews(entity, &changed_group, 1); }
+			void UpdateComponentViews(Entity* entity, const ComponentSignature& changed_components);
 
+			void UpdateComponentViewsOnEntityRemoval(Entity* killed_entity);
 			void UpdateGroupViewsOnEntityRemoval(Entity* killed_entity);
-			void UpdateGroupViewsOnEntityRemoval(Entity* killed_entity, const GroupTag& ignore_tag);
 
-			decltype(m_group_views)::iterator UnregisterFromView(Entity* entity, decltype(m_group_views)::iterator view);
-			decltype(m_component_views)::iterator UnregisterFromView(Entity* entity, decltype(m_component_views)::iterator view);
 
 			void UnregisterView(decltype(m_group_views)::iterator view);
 			void UnregisterView(decltype(m_component_views)::iterator view);
+
+			void EvictView(decltype(m_group_views)::iterator view);
+			void EvictView(decltype(m_component_views)::iterator view);
+
+			template <typename TagType, typename HistoryType>
+			static void RememberEvictedView(HistoryType& history, const TagType& tag, size_t rebuild_count);
+			template <typename TagType, typename HistoryType>
+			size_t ForgetEvictedView(HistoryType& history, const TagType& tag); // rebuild count of an evicted view, 0 if not remembered
+			void EvictUnusedViews();
+
+			void PlayBackCommands();
+
+			void RegisterSnapshotComponent(SnapshotComponent&& info);
 		};
 
 		// Template Definitions
@@ -209,75 +485,179 @@ namespace ae {
 		void EntityManagerType::Clear() {
 
 			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not view components, ComponentType must inherit from Component");
+			AE_ASSERT(!IsIteratingInParallel(), "Could not clear components, structural changes are not allowed during parallel iteration");
 
 			// find
-			auto location = m_components.find(typeid(ComponentType));
-			if (location == m_components.end())
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+			if (!storage)
 				return;
 
-			// iterate through components
-			for (auto comp_it(location->second.begin()); comp_it != location->second.end(); comp_it++) {
-				Entity* entity = (*comp_it)->GetEntity();
+			// mark & remove
+			for (Component* component : storage->components)
+				component->GetEntity()->m_marked_for_removal = true;
 
-				// remove from views
-				UpdateGroupViewsOnEntityRemoval(entity);
-				UpdateComponentViewsOnEntityRemoval(entity);
+			RemoveMarkedEntities(storage->components.size());
+		}
 
-				// remove from groups
-				UnregisterEntityFromGroup(AllEntitiesGroup, entity);
+		template <typename ComponentType>
+		void EntityManagerType::ViewComponents(const std::function<void(ComponentType&)>& operation) {
 
-				for(EntityGroup e_group : entity->m_groups)
-					UnregisterEntityFromGroup(e_group, entity);
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not view components, ComponentType must inherit from Component");
 
-				// delete components
-				for (Component* e_comp : entity->m_components) {
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
 
-					// ignore clear component type's component
-					if (typeid(*e_comp) != typeid(**comp_it))
-						EraseComponent(e_comp);
-				}
-
-				// clear heap space
-				delete entity;
-				delete* comp_it;
-			}
+			// check if exists
+			if (!storage)
+				return;
 
-			// clean up
-			m_components.erase(location);
+			// iterate
+			for (Component* comp : storage->components)
+				operation(*static_cast<ComponentType*>(comp));
 		}
 
 		template <typename ComponentType>
-		void EntityManagerType::ViewComponents(const std::function<void(ComponentType&)>& operation) {
+		void EntityManagerType::ParallelViewComponents(const std::function<void(ComponentType&)>& operation, size_t grain) {
 
 			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not view components, ComponentType must inherit from Component");
 
-			auto location = m_components.find(typeid(ComponentType));
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
 
 			// check if exists
-			if (location == m_components.end())
+			if (!storage)
 				return;
 
-			// iterate
-			for (Component* comp : location->second)
-				operation(*static_cast<ComponentType*>(comp));
+			// iterate in chunks of 'grain' components
+			const std::vector<Component*>& components = storage->components;
+
+			ParallelIterationScope parallel_iteration(*this);
+
+			JobPool.ParallelFor(components.size(), grain, [&operation, &components](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					operation(*static_cast<ComponentType*>(components[i]));
+			});
 		}
 
 		template <typename ComponentType>
 		void EntityManagerType::SortView(const std::function<bool(ComponentType&, ComponentType&)>& compare) {
 
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort components, sorting is not allowed during parallel iteration");
 			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not sort components, ComponentType must inherit from Component");
 
 			// find
-			auto location = m_components.find(typeid(ComponentType));
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
 
-			if (location == m_components.end())
+			if (!storage)
 				return;
 
 			// sort
-			std::sort(location->second.begin(), location->second.end(),
+			std::sort(storage->components.begin(), storage->components.end(),
 				[&compare](Component* comp1, Component* comp2) -> bool {
 					return compare(*static_cast<ComponentType*>(comp1), *static_cast<ComponentType*>(comp2));
 			});
+
+			storage->UpdatePositions();
+		}
+
+		template <typename ComponentType, typename KeyFunctionType>
+		void EntityManagerType::SortViewByKey(const KeyFunctionType& key) {
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort components, sorting is not allowed during parallel iteration");
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not sort components, ComponentType must inherit from Component");
+
+			// find
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+
+			if (!storage)
+				return;
+
+			// sort
+			SortByKey(storage->components, [&key](Component* component) {
+				return key(*static_cast<const ComponentType*>(component));
+			});
+
+			storage->UpdatePositions();
+		}
+		template <typename KeyFunctionType>
+		void EntityManagerType::SortViewByKey(const KeyFunctionType& key, EntityGroup group) {
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort entities, sorting is not allowed during parallel iteration");
+			// find
+			auto it = m_entities.find(group);
+
+			if (it == m_entities.end())
+				return;
+
+			// sort
+			SortByKey(it->second, [&key](Entity* entity) {
+				return key(static_cast<const Entity&>(*entity));
+			});
+
+			UpdateGroupPositions(group, it->second);
+		}
+		template <typename KeyFunctionType>
+		void EntityManagerType::SortViewByKey(const KeyFunctionType& key, const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups) {
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort entities, sorting is not allowed during parallel iteration");
+			// check for logic
+			AE_ECS_ADVANCED_GROUP_VIEW_DEBUG_LOGIC_TEST(
+				groups, exclude_groups,
+				"Could not sort entities, invalid groups' sizes",
+				"Could not sort entities, groups and exclude_groups shared at least one group"
+			);
+
+			// find or register
+			auto location = FindOrRegisterView(GroupTag(groups, exclude_groups));
+			if (location == m_group_views.end())
+				return;
+
+			// sort
+			SortByKey(location->second.entities, [&key](Entity* entity) {
+				return key(static_cast<const Entity&>(*entity));
+			});
+
+			location->second.UpdatePositions();
+			location->second.sort_count++;
+		}
+		template <typename KeyFunctionType>
+		void EntityManagerType::SortViewByKey(const KeyFunctionType& key, const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort entities, sorting is not allowed during parallel iteration");
+			// check for logic
+			AE_ECS_ADVANCED_COMP_VIEW_DEBUG_LOGIC_TEST(
+				components.m_components, exclude_components.m_components,
+				"Could not sort entities, invalid ComponentPacks' sizes",
+				"Could not sort entities, components and exclude_components share at least one component type"
+			);
+
+			// find or register
+			auto location = FindOrRegisterView(ComponentTag(components.m_components, exclude_components.m_components));
+			if (location == m_component_views.end())
+				return;
+
+			// sort
+			SortByKey(location->second.entities, [&key](Entity* entity) {
+				return key(static_cast<const Entity&>(*entity));
+			});
+
+			location->second.UpdatePositions();
+			location->second.sort_count++;
+		}
+
+		template <typename ElementType, typename KeyFunctionType>
+		void EntityManagerType::SortByKey(std::vector<ElementType*>& elements, const KeyFunctionType& key) {
+
+			// extract keys once
+			std::vector<decltype(key(std::declval<ElementType*>()))> keys;
+			keys.reserve(elements.size());
+
+			for (ElementType* element : elements)
+				keys.push_back(key(element));
+
+			// stable radix sort
+			std::vector<std::uint32_t> order;
+			GetSortOrder(keys, order);
+
+			ApplySortOrder(elements.data(), order);
 		}
 
 		template <typename ComponentType>
@@ -286,13 +666,13 @@ namespace ae {
 			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not retrieve iterators to components' vector, ComponentType must inherit from Component");
 
 			// find
-			auto location = m_components.find(typeid(ComponentType));
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
 
-			if (location == m_components.end())
+			if (!storage)
 				return {};
 
 			// return
-			return { location->second.begin(), location->second.end() };
+			return { storage->components.begin(), storage->components.end() };
 		}
 
 		template <typename ComponentType>
@@ -300,13 +680,176 @@ namespace ae {
 			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not count components, ComponentType must inherit from Component");
 			
 			// find
-			auto it = m_components.find(typeid(ComponentType));
-			if (it == m_components.end())
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+			if (!storage)
 				return 0;
 		
 			// return
-			return it->second.size();
+			return storage->components.size();
 		}
+
+		template <typename ComponentType>
+		const std::vector<EntityId>& EntityManagerType::GetAddedEntities() const {
+			return GetChanges<ComponentType>(&ComponentStorageBase::added);
+		}
+		template <typename ComponentType>
+		const std::vector<EntityId>& EntityManagerType::GetChangedEntities() const {
+			return GetChanges<ComponentType>(&ComponentStorageBase::changed);
+		}
+		template <typename ComponentType>
+		const std::vector<EntityId>& EntityManagerType::GetRemovedEntities() const {
+			return GetChanges<ComponentType>(&ComponentStorageBase::removed);
+		}
+
+		template <typename ComponentType>
+		std::uint32_t EntityManagerType::GetChangeVersion() const {
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not retrieve change version, ComponentType must inherit from Component");
+
+			// find
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+			if (!storage)
+				return 0;
+
+			// return
+			return storage->version;
+		}
+
+		template <typename ComponentType>
+		const std::vector<EntityId>& EntityManagerType::GetChanges(ChangeList ComponentStorageBase::* list) const {
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not retrieve changes, ComponentType must inherit from Component");
+
+			static const std::vector<EntityId> no_changes;
+
+			// find
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+			if (!storage)
+				return no_changes;
+
+			// return
+			return (storage->*list).previous;
+		}
+
+		template <typename ComponentType>
+		void EntityManagerType::Reserve(size_t count) {
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not reserve components, ComponentType must inherit from Component");
+
+			FindOrCreateStorage<ComponentType>()->Reserve(count);
+		}
+
+		template <typename ComponentType>
+		PoolMemoryStats EntityManagerType::GetMemoryStats() const {
+			AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "Could not retrieve memory stats, ComponentType must inherit from Component");
+
+			// find
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+			if (!storage)
+				return {};
+
+			// return
+			return storage->GetMemoryStats();
+		}
+
+		template <typename ComponentType>
+		ComponentStorage<ComponentType>* EntityManagerType::FindStorage() const {
+
+			const ComponentTypeId id = GetComponentTypeId<ComponentType>();
+
+			if (id >= m_storages.size())
+				return nullptr;
+
+			return static_cast<ComponentStorage<ComponentType>*>(m_storages[id]);
+		}
+
+		template <typename ComponentType>
+		ComponentStorage<ComponentType>* EntityManagerType::FindOrCreateStorage() {
+
+			ComponentStorage<ComponentType>* storage = FindStorage<ComponentType>();
+
+			if (!storage) {
+				const ComponentTypeId id = GetComponentTypeId<ComponentType>();
+
+				if (m_storages.size() <= id)
+					m_storages.resize(id + 1, nullptr);
+
+				storage = new ComponentStorage<ComponentType>();
+				m_storages[id] = storage;
+			}
+
+			return storage;
+		}
+
+		template <typename ComponentType, typename ...ArgsType>
+		ComponentType* EntityManagerType::CreateComponent(ArgsType&&... args) {
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not add component, structural changes are not allowed during parallel iteration");
+
+			ComponentStorage<ComponentType>* storage = FindOrCreateStorage<ComponentType>();
+
+			// construct in place
+			ComponentType* component = storage->Create(std::forward<ArgsType>(args)...);
+			storage->Insert(component);
+
+			return component;
+		}
+
+		template <typename ComponentType, bool single_use, typename ...ArgsType>
+		std::function<Component*(EntityManagerType&)> MakeComponentFactory(ArgsType&&... args) {
+
+			// arguments are copied, a single-use factory hands them over to the constructor (moved, or as references if it takes them so)
+			return [arguments = std::make_tuple(std::forward<ArgsType>(args)...)](EntityManagerType& manager) mutable -> Component* {
+				if constexpr (single_use) {
+					return std::apply([&manager](auto&... unpacked_arguments) -> Component* {
+						if constexpr (std::is_constructible<ComponentType, typename std::remove_reference<decltype(unpacked_arguments)>::type&&...>::value)
+							return manager.CreateComponent<ComponentType>(std::move(unpacked_arguments)...);
+						else
+							return manager.CreateComponent<ComponentType>(unpacked_arguments...);
+					}, arguments);
+				}
+				else {
+					return std::apply([&manager](const auto&... unpacked_arguments) -> Component* {
+						return manager.CreateComponent<ComponentType>(unpacked_arguments...);
+					}, arguments);
+				}
+			};
+		}
+	}
+
+	template <typename ComponentType, typename ...ArgsType>
+	void EntityCommandBuffer::AddComponent(EntityId entity, ArgsType&&... args) {
+
+		AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "ComponentType must inherit from ae::Component, '" << typeid(ComponentType).name() << "' does not");
+
+		Command command;
+		command.type = CommandType::AddComponent;
+		command.entity = entity;
+		command.component = internal::GetComponentTypeId<ComponentType>();
+
+		// arguments are copied until playback, which constructs the component once
+		command.create = internal::MakeComponentFactory<ComponentType, true>(std::forward<ArgsType>(args)...);
+
+		Record(std::move(command));
+	}
+
+	template <typename ComponentType, typename ...ArgsType>
+	Prefab& Prefab::AddComponent(ArgsType&&... args) {
+
+		AE_ASSERT((std::is_base_of<Component, ComponentType>::value), "ComponentType must inherit from ae::Component, '" << typeid(ComponentType).name() << "' does not");
+		AE_ASSERT(!HasComponent<ComponentType>(), "Prefab already has '" << typeid(ComponentType).name() << "' component");
+
+		ComponentEntry entry;
+		entry.id = internal::GetComponentTypeId<ComponentType>();
+
+		entry.find_or_create_storage = [](internal::EntityManagerType& manager) -> internal::ComponentStorageBase* {
+			return manager.FindOrCreateStorage<ComponentType>();
+		};
+
+		// arguments are copied, every instance constructs its component from them
+		entry.create = internal::MakeComponentFactory<ComponentType, false>(std::forward<ArgsType>(args)...);
+
+		m_signature.set(entry.id);
+		m_components.push_back(std::move(entry));
+
+		return *this;
 	}
 
 	extern internal::EntityManagerType EntityManager;
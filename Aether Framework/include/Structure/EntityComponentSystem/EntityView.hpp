@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Entity View
+///
+///		Dense storage of entities belonging to an advanced view (tagged by GroupTag or ComponentTag).
+///		Every view remembers the position of each entity it contains (indexed by EntityId::index),
+///		thus checking membership, inserting and erasing an entity take constant time.
+///		Erasing swaps the last entity into the place of the erased one, unless the order has to be preserved.
+///		Views count their insertions, erasures and sorts for EntityManager's statistics (see Statistics.hpp).
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+
+namespace ae {
+	class Entity;
+
+	namespace internal {
+
+		class EntityView {
+		public:
+			std::vector<Entity*> entities;
+
+			bool Contains(const Entity* entity) const;
+			
+			void Insert(Entity* entity);
+			void Insert(std::vector<Entity*>::const_iterator begin, std::vector<Entity*>::const_iterator end);
+			void Erase(Entity* entity, bool preserve_order);
+			void EraseIf(const std::function<bool(const Entity*)>& predicate); // keeps the order
+			void Clear();
+
+			// has to be called after entities were reordered
+			void UpdatePositions();
+
+			size_t GetReservedBytes() const;
+
+			// number of Refresh calls made before the view was last used, can be set by systems running in parallel
+			size_t GetLastUse() const { return m_last_use.value.load(std::memory_order_relaxed); }
+			void SetLastUse(size_t refresh_count);
+
+			// statistics
+			size_t update_count = 0; // inserted and erased entities
+			size_t sort_count = 0;
+			size_t rebuild_count = 0;
+			std::chrono::nanoseconds last_rebuild_duration{ 0 };
+			std::chrono::nanoseconds update_duration{ 0 };
+
+		private:
+			static constexpr std::uint32_t c_no_position = 0xFFFFFFFF;
+			std::vector<std::uint32_t> m_positions;
+
+			// atomic, copied by value so that views stay movable
+			struct LastUse {
+				std::atomic<size_t> value = 0;
+
+				LastUse() = default;
+				LastUse(const LastUse& other) : value(other.value.load(std::memory_order_relaxed)) {}
+				LastUse& operator=(const LastUse& other) { value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed); return *this; }
+			};
+			LastUse m_last_use;
+		};
+	}
+}
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Group Set
+///
+///		Dynamic bitset of groups, a group is a bit index. Groups below AE_ECS_INLINE_GROUPS are stored inline,
+///		greater ones allocate additional words. Comparisons, inclusion and intersection tests work on whole 64-bit words,
+///		missing words are treated as zeros, so sets holding the same groups are equal regardless of their capacity.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Utility.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <iterator>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+// number of groups stored without allocation, rounded up to a multiple of 64
+#ifndef AE_ECS_INLINE_GROUPS
+	#define AE_ECS_INLINE_GROUPS 128
+#endif
+
+namespace ae {
+	namespace internal {
+
+		class GroupSet {
+		public:
+			GroupSet() = default;
+
+			void Set(EntityGroup group) {
+				GetWord(group / 64) |= (std::uint64_t(1) << (group % 64));
+			}
+			void Reset(EntityGroup group) {
+				if (group / 64 < GetWordCount())
+					GetWord(group / 64) &= ~(std::uint64_t(1) << (group % 64));
+			}
+			bool Test(EntityGroup group) const {
+				return (ReadWord(group / 64) >> (group % 64)) & 1;
+			}
+
+			// keeps allocated words
+			void Clear() {
+				std::fill(std::begin(m_inline), std::end(m_inline), 0);
+				std::fill(m_words.begin(), m_words.end(), 0);
+			}
+
+			bool None() const {
+				for (size_t i = 0; i < GetWordCount(); i++)
+					if (ReadWord(i))
+						return false;
+
+				return true;
+			}
+
+			// whether all groups of 'other' are in this set
+			bool Includes(const GroupSet& other) const {
+				for (size_t i = 0; i < other.GetWordCount(); i++)
+					if ((ReadWord(i) & other.ReadWord(i)) != other.ReadWord(i))
+						return false;
+
+				return true;
+			}
+			bool Intersects(const GroupSet& other) const {
+				const size_t count = std::min(GetWordCount(), other.GetWordCount());
+
+				for (size_t i = 0; i < count; i++)
+					if (ReadWord(i) & other.ReadWord(i))
+						return true;
+
+				return false;
+			}
+
+			GroupSet& operator|=(const GroupSet& other) {
+				for (size_t i = 0; i < other.GetWordCount(); i++)
+					if (std::uint64_t word = other.ReadWord(i))
+						GetWord(i) |= word;
+
+				return *this;
+			}
+
+			bool operator==(const GroupSet& other) const {
+				const size_t count = std::max(GetWordCount(), other.GetWordCount());
+
+				for (size_t i = 0; i < count; i++)
+					if (ReadWord(i) != other.ReadWord(i))
+						return false;
+
+				return true;
+			}
+			bool operator!=(const GroupSet& other) const { return !(*this == other); }
+
+			size_t Hash() const {
+				size_t hash = 0;
+
+				// zero words are skipped, equal sets of different capacities hash the same
+				for (size_t i = 0; i < GetWordCount(); i++)
+					if (std::uint64_t word = ReadWord(i))
+						hash ^= size_t(word * 0x9E3779B97F4A7C15ull + i) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+				return hash;
+			}
+
+			// the lowest group, AllEntitiesGroup if the set is empty
+			EntityGroup First() const {
+				for (size_t i = 0; i < GetWordCount(); i++)
+					if (std::uint64_t word = ReadWord(i))
+						return EntityGroup(i * 64 + CountTrailingZeros(word));
+
+				return AllEntitiesGroup;
+			}
+
+			// calls operation(group) for every group in ascending order
+			template <typename OperationType>
+			void ForEach(const OperationType& operation) const {
+				for (size_t i = 0; i < GetWordCount(); i++)
+					for (std::uint64_t word = ReadWord(i); word; word &= word - 1)
+						operation(EntityGroup(i * 64 + CountTrailingZeros(word)));
+			}
+
+		private:
+			static constexpr size_t InlineWords = (AE_ECS_INLINE_GROUPS + 63) / 64;
+
+			std::uint64_t m_inline[InlineWords] = {};
+			std::vector<std::uint64_t> m_words; // words following the inline ones
+
+			size_t GetWordCount() const { return InlineWords + m_words.size(); }
+
+			std::uint64_t ReadWord(size_t index) const {
+				if (index < InlineWords)
+					return m_inline[index];
+
+				return (index - InlineWords < m_words.size()) ? m_words[index - InlineWords] : 0;
+			}
+			std::uint64_t& GetWord(size_t index) {
+				if (index < InlineWords)
+					return m_inline[index];
+
+				if (index - InlineWords >= m_words.size())
+					m_words.resize(index - InlineWords + 1, 0);
+
+				return m_words[index - InlineWords];
+			}
+
+			static unsigned CountTrailingZeros(std::uint64_t word) {
+			#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward64(&index, word);
+				return unsigned(index);
+			#else
+				return unsigned(__builtin_ctzll(word));
+			#endif
+			}
+		};
+	}
+}
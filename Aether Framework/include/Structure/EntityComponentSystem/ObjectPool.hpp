@@ -0,0 +1,181 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Object Pool
+///
+///		Allocates objects of a single type in fixed-size chunks of contiguous memory.
+///		Chunks are never moved nor freed until the pool is destroyed, thus objects keep stable addresses.
+///		Slots of destroyed objects are reused by the next created object, so a pool which has grown once does not touch the global allocator anymore.
+///		Reserve(count) allocates chunks up front, so that at least 'count' objects fit in the pool.
+/// 
+///		The pool does not track live objects, its owner has to destroy them before the pool goes out of scope.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace ae {
+
+	struct PoolMemoryStats {
+		size_t live_count = 0;     // objects currently constructed
+		size_t capacity = 0;       // objects that fit in allocated chunks
+		size_t chunk_count = 0;
+		size_t reserved_bytes = 0; // memory held by chunks
+	};
+
+	namespace internal {
+
+		template <typename ObjectType>
+		class ObjectPool {
+		public:
+			static constexpr size_t c_chunk_byte_size = 16384;
+			static constexpr size_t c_chunk_capacity = (sizeof(ObjectType) < c_chunk_byte_size) ? (c_chunk_byte_size / sizeof(ObjectType)) : 1;
+
+			ObjectPool() = default;
+			ObjectPool(const ObjectPool&) = delete;
+			ObjectPool(ObjectPool&&) = delete;
+
+			template <typename ...ArgsType>
+			ObjectType* Create(ArgsType&&... args);
+			void Destroy(ObjectType* object);
+
+			void Reserve(size_t count);
+			PoolMemoryStats GetMemoryStats() const;
+
+			// frees every slot at once, objects have to be destroyed already, next objects are placed in memory order
+			void ReleaseAll();
+
+		private:
+			struct Chunk {
+				alignas(ObjectType) unsigned char memory[sizeof(ObjectType) * c_chunk_capacity];
+
+				ObjectType* GetSlot(size_t index) { return reinterpret_cast<ObjectType*>(memory) + index; }
+			};
+
+			std::vector<std::unique_ptr<Chunk>> m_chunks;
+			std::vector<ObjectType*> m_free_slots;
+			size_t m_last_chunk_used = c_chunk_capacity;
+
+			ObjectType* AcquireSlot();
+		};
+
+		// Template Definitions
+
+		template <typename ObjectType>
+		ObjectType* ObjectPool<ObjectType>::AcquireSlot() {
+
+			// reuse a slot of a destroyed object
+			if (!m_free_slots.empty()) {
+				ObjectType* slot = m_free_slots.back();
+				m_free_slots.pop_back();
+				return slot;
+			}
+
+			// allocate next chunk if needed
+			if (m_last_chunk_used == c_chunk_capacity) {
+				m_chunks.push_back(std::make_unique<Chunk>());
+				m_last_chunk_used = 0;
+			}
+
+			return m_chunks.back()->GetSlot(m_last_chunk_used++);
+		}
+
+		template <typename ObjectType>
+		template <typename ...ArgsType>
+		ObjectType* ObjectPool<ObjectType>::Create(ArgsType&&... args) {
+			return new (AcquireSlot()) ObjectType(std::forward<ArgsType>(args)...);
+		}
+
+		template <typename ObjectType>
+		void ObjectPool<ObjectType>::Destroy(ObjectType* object) {
+			object->~ObjectType();
+			m_free_slots.push_back(object);
+		}
+
+		template <typename ObjectType>
+		void ObjectPool<ObjectType>::Reserve(size_t count) {
+
+			// enough room already
+			if (count <= m_chunks.size() * c_chunk_capacity)
+				return;
+
+			// allocate missing chunks
+			const size_t old_chunk_count = m_chunks.size();
+
+			while (m_chunks.size() * c_chunk_capacity < count)
+				m_chunks.push_back(std::make_unique<Chunk>());
+
+			m_free_slots.reserve(m_chunks.size() * c_chunk_capacity);
+
+			// slots are pushed in reverse, so that they are taken in memory order
+			for (size_t chunk = m_chunks.size(); chunk > old_chunk_count; chunk--)
+				for (size_t i = c_chunk_capacity; i > 0; i--)
+					m_free_slots.push_back(m_chunks[chunk - 1]->GetSlot(i - 1));
+
+			// untouched slots of the previously last chunk are taken first
+			if (old_chunk_count > 0)
+				for (size_t i = c_chunk_capacity; i > m_last_chunk_used; i--)
+					m_free_slots.push_back(m_chunks[old_chunk_count - 1]->GetSlot(i - 1));
+
+			m_last_chunk_used = c_chunk_capacity;
+		}
+
+		template <typename ObjectType>
+		void ObjectPool<ObjectType>::ReleaseAll() {
+			m_free_slots.clear();
+			m_free_slots.reserve(m_chunks.size() * c_chunk_capacity);
+
+			// slots are pushed in reverse, so that they are taken in memory order
+			for (size_t chunk = m_chunks.size(); chunk > 0; chunk--)
+				for (size_t i = c_chunk_capacity; i > 0; i--)
+					m_free_slots.push_back(m_chunks[chunk - 1]->GetSlot(i - 1));
+
+			m_last_chunk_used = c_chunk_capacity;
+		}
+
+		template <typename ObjectType>
+		PoolMemoryStats ObjectPool<ObjectType>::GetMemoryStats() const {
+
+			PoolMemoryStats stats;
+			stats.chunk_count = m_chunks.size();
+			stats.capacity = m_chunks.size() * c_chunk_capacity;
+			stats.live_count = stats.capacity - m_free_slots.size() - (c_chunk_capacity - m_last_chunk_used);
+			stats.reserved_bytes = m_chunks.size() * sizeof(Chunk);
+
+			return stats;
+		}
+	}
+}
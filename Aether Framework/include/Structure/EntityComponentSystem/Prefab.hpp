@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Prefab
+///
+///		Describes a set of components (with their initial values) and groups, which can be instantiated many times at once
+///		using EntityManager.CreateEntities(count, prefab).
+///		Arguments of AddComponent are copied, each instance constructs its own component from them.
+/// 
+///		Bulk creation reserves storages once and, since all instances share the same signature and groups,
+///		checks every affected advanced view only once and inserts the whole batch into it.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../../Core/Preprocessor.hpp"
+
+#include "Utility.hpp"
+#include "GroupSet.hpp"
+
+#include <vector>
+#include <functional>
+
+namespace ae {
+	class Component;
+
+	namespace internal {
+		class EntityManagerType;
+		class ComponentStorageBase;
+	}
+
+	class Prefab {
+		friend class internal::EntityManagerType;
+
+	public:
+		Prefab() = default;
+
+		// defined in EntityManager.hpp
+		template <typename ComponentType, typename ...ArgsType>
+		Prefab& AddComponent(ArgsType&&... args);
+
+		template <typename ComponentType>
+		bool HasComponent() const;
+
+		Prefab& AddToGroup(EntityGroup group);
+		Prefab& AddToGroups(const std::vector<EntityGroup>& groups);
+
+		bool IsInGroup(EntityGroup group) const;
+
+	private:
+		struct ComponentEntry {
+			internal::ComponentTypeId id;
+			internal::ComponentStorageBase* (*find_or_create_storage)(internal::EntityManagerType&);
+			std::function<Component*(internal::EntityManagerType&)> create;
+		};
+
+		std::vector<ComponentEntry> m_components;
+		internal::ComponentSignature m_signature;
+		internal::GroupSet m_groups; // does not store AllEntitiesGroup
+	};
+
+	// Template Definitions
+
+	template <typename ComponentType>
+	bool Prefab::HasComponent() const {
+		return m_signature.test(internal::GetComponentTypeId<ComponentType>());
+	}
+}
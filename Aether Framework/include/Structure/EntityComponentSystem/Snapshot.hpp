@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Snapshot
+///
+///		EntityManager.SaveSnapshot(filename) writes all entities, their groups and components of registered types to a versioned binary file,
+///		EntityManager.LoadSnapshot(filename) clears EntityManager and recreates them in bulk. Components of types that were not registered are not saved.
+///		Entity handles are not preserved, but the order of AllEntitiesGroup and of every component storage is. Entities killed but not removed yet
+///		are loaded as killed and removed by the next Refresh.
+/// 
+///		Component types have to be registered with a name, which identifies them in the file (component type ids differ between runs):
+/// 
+///		RegisterSnapshotComponent<ComponentType>(name)
+///			> the component declares a trivially copyable 'SnapshotData' type, 'SnapshotData GetSnapshotData() const' and a constructor taking 'const SnapshotData&'.
+///			  Data of all components of the type is stored as one contiguous block of records.
+/// 
+///		RegisterSnapshotComponent<ComponentType>(name, save, load)
+///			> save appends any bytes describing the component, load receives them and adds the component to the entity.
+/// 
+///		Data is stored in the native byte order. Loading fails (and leaves EntityManager untouched) if the file is missing, corrupted, 
+///		has a different version or if a registered type's SnapshotData size changed, sections of unregistered types are skipped.
+/// 
+///		Example:
+///			struct Health : ae::Component {
+///				struct SnapshotData { float value, max; } data;
+///				Health(const SnapshotData& data) : data(data) {}
+///				SnapshotData GetSnapshotData() const { return data; }
+///			};
+///			EntityManager.RegisterSnapshotComponent<Health>("Health");
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Entity.hpp"
+#include "EntityManager.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace ae {
+	namespace internal {
+
+		// Template Definitions
+
+		template <typename ComponentType>
+		void EntityManagerType::RegisterSnapshotComponent(const std::string& name) {
+
+			typedef typename ComponentType::SnapshotData SnapshotData;
+
+			static_assert(std::is_base_of<Component, ComponentType>::value, "ComponentType must inherit from ae::Component");
+			static_assert(std::is_trivially_copyable<SnapshotData>::value, "ComponentType::SnapshotData must be trivially copyable");
+
+			SnapshotComponent info;
+			info.name = name;
+			info.id = GetComponentTypeId<ComponentType>();
+			info.record_size = sizeof(SnapshotData);
+
+			info.find_or_create_storage = [](EntityManagerType& manager) -> ComponentStorageBase* {
+				return manager.FindOrCreateStorage<ComponentType>();
+			};
+
+			info.save = [](const Component& component, std::vector<std::uint8_t>& bytes) {
+				const SnapshotData data = static_cast<const ComponentType&>(component).GetSnapshotData();
+				const std::uint8_t* data_bytes = reinterpret_cast<const std::uint8_t*>(&data);
+
+				bytes.insert(bytes.end(), data_bytes, data_bytes + sizeof(SnapshotData));
+			};
+
+			// the whole block is constructed directly in the storage, indices and records in the file are not aligned
+			info.load_records = [](EntityManagerType& manager, const std::vector<Entity*>& entities, const std::uint8_t* indices, const std::uint8_t* records, size_t count) {
+				const ComponentTypeId id = GetComponentTypeId<ComponentType>();
+				ComponentStorage<ComponentType>* storage = manager.FindOrCreateStorage<ComponentType>();
+
+				for (size_t i = 0; i < count; i++) {
+					std::uint32_t index;
+					std::memcpy(&index, indices + i * sizeof(std::uint32_t), sizeof(std::uint32_t));
+
+					Entity& entity = *entities[index];
+
+					if (entity.m_signature.test(id))
+						continue;
+
+					SnapshotData data;
+					std::memcpy(&data, records + i * sizeof(SnapshotData), sizeof(SnapshotData));
+
+					ComponentType* component = storage->Create(data);
+					storage->Insert(component);
+					entity.AttachComponent(id, component);
+				}
+			};
+
+			RegisterSnapshotComponent(std::move(info));
+		}
+
+		template <typename ComponentType>
+		void EntityManagerType::RegisterSnapshotComponent(
+			const std::string& name,
+			const std::function<void(const ComponentType&, std::vector<std::uint8_t>&)>& save,
+			const std::function<void(Entity&, const std::uint8_t*, size_t)>& load)
+		{
+			static_assert(std::is_base_of<Component, ComponentType>::value, "ComponentType must inherit from ae::Component");
+
+			SnapshotComponent info;
+			info.name = name;
+			info.id = GetComponentTypeId<ComponentType>();
+			info.record_size = 0;
+
+			info.find_or_create_storage = [](EntityManagerType& manager) -> ComponentStorageBase* {
+				return manager.FindOrCreateStorage<ComponentType>();
+			};
+
+			info.save = [save](const Component& component, std::vector<std::uint8_t>& bytes) {
+				save(static_cast<const ComponentType&>(component), bytes);
+			};
+
+			// the user adds the component, advanced views are updated as usual
+			info.load = [load](EntityManagerType&, Entity& entity, const std::uint8_t* bytes, size_t size) {
+				load(entity, bytes, size);
+			};
+
+			RegisterSnapshotComponent(std::move(info));
+		}
+	}
+}
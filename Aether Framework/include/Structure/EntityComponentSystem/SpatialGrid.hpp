@@ -0,0 +1,262 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Spatial Grid
+///
+///		SpatialGrid is a loose uniform grid of square cells, each entity is stored once, in the cell containing the center of its bounds,
+///		queries look into neighbouring cells as well. Entities wider or higher than a cell are kept aside and checked by every query,
+///		thus cell size should be close to the size of the largest common entities.
+///		Cells are created on demand (the grid is not limited to any area) and are kept after they become empty, Clear releases them.
+///		Moving an entity within its cell only updates its bounds, moving it to another cell relinks it in constant time.
+/// 
+///		QueryRect, QueryRadius and QueryPoint return every entity whose bounds overlap the given area (edges included, points follow Rectangle::IsPointInside),
+///		each entity is reported once, in no particular order. Queries do not modify the grid and can be run from multiple threads at once.
+/// 
+///		SpatialIndex<BoundsComponentType> keeps a grid in sync with a component describing entities' bounds, retrieved by the given function.
+///		Update() should be called once per tick, after EntityManager.Refresh, it applies added, changed and removed components
+///		reported by change tracking (see EntityManager.hpp), thus moved components must be marked with Entity::MarkChanged.
+///		If Update has not been called for a whole tick, or it is called for the first time, the grid is rebuilt from all components.
+/// 
+///		Usage:
+///			ae::SpatialIndex<BoundsComp> index(64.f, [](const BoundsComp& bounds) { return bounds.GetGlobalBounds(); });
+///			
+///			index.Update();
+///			for (ae::EntityId id : index.QueryRadius(explosion_center, 100.f))
+///				ae::EntityManager.GetEntity(id)->Kill();
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../../System/Rectangle.hpp"
+#include "../../System/Vector2.hpp"
+
+#include "Utility.hpp"
+#include "Entity.hpp"
+#include "EntityManager.hpp"
+
+#include <vector>
+#include <functional>
+
+namespace ae {
+
+	class SpatialGrid {
+	public:
+		explicit SpatialGrid(float cell_size = 64.f);
+
+		// inserts the entity or updates its bounds if it is already stored
+		void Insert(EntityId entity, const FloatRect& bounds);
+		void Remove(EntityId entity);
+		void Clear();
+
+		bool Contains(EntityId entity) const;
+		size_t CountEntities() const { return m_count; }
+		size_t CountCells() const { return m_cell_count; }
+		float GetCellSize() const { return m_cell_size; }
+
+		// append found entities to 'result'
+		void QueryRect(const FloatRect& rect, std::vector<EntityId>& result) const;
+		void QueryRadius(const Vector2f& center, float radius, std::vector<EntityId>& result) const;
+		void QueryPoint(const Vector2f& point, std::vector<EntityId>& result) const;
+
+		std::vector<EntityId> QueryRect(const FloatRect& rect) const;
+		std::vector<EntityId> QueryRadius(const Vector2f& center, float radius) const;
+		std::vector<EntityId> QueryPoint(const Vector2f& point) const;
+
+	private:
+		static constexpr std::uint32_t NoEntry = 0xFFFFFFFF;
+
+		struct Entry {
+			EntityId id = InvalidEntityId;
+			FloatRect bounds;
+			std::uint64_t cell = 0; // key of the cell containing the center
+			bool oversized = false;
+			std::uint32_t previous = NoEntry, next = NoEntry; // entries of the same cell
+		};
+		struct Cell {
+			std::uint64_t key = 0;
+			std::uint32_t first = NoEntry;
+			bool used = false;
+		};
+
+		float m_cell_size;
+		size_t m_count = 0;
+		std::vector<Entry> m_entries; // indexed by EntityId::index
+
+		// open addressing hash table of cells, its size is a power of 2
+		std::vector<Cell> m_cells;
+		size_t m_cell_count = 0;
+
+		// entries larger than a cell, checked by every query
+		std::uint32_t m_first_oversized = NoEntry;
+
+		static std::uint64_t GetCellKey(int x, int y);
+		int GetCellCoordinate(float position) const;
+		std::uint64_t GetCellKey(const FloatRect& bounds) const;
+
+		const Cell* FindCell(std::uint64_t key) const;
+		Cell& FindOrCreateCell(std::uint64_t key);
+
+		void Link(std::uint32_t index);
+		void Unlink(std::uint32_t index);
+
+		// calls 'test' for every entry which may overlap 'area'
+		template <typename TestType>
+		void Search(const FloatRect& area, const TestType& test, std::vector<EntityId>& result) const;
+	};
+
+	template <typename BoundsComponentType>
+	class SpatialIndex {
+	public:
+		SpatialIndex(float cell_size, const std::function<FloatRect(const BoundsComponentType&)>& get_bounds);
+
+		void Update();
+		void Rebuild();
+
+		const SpatialGrid& GetGrid() const { return m_grid; }
+
+		void QueryRect(const FloatRect& rect, std::vector<EntityId>& result) const { m_grid.QueryRect(rect, result); }
+		void QueryRadius(const Vector2f& center, float radius, std::vector<EntityId>& result) const { m_grid.QueryRadius(center, radius, result); }
+		void QueryPoint(const Vector2f& point, std::vector<EntityId>& result) const { m_grid.QueryPoint(point, result); }
+
+		std::vector<EntityId> QueryRect(const FloatRect& rect) const { return m_grid.QueryRect(rect); }
+		std::vector<EntityId> QueryRadius(const Vector2f& center, float radius) const { return m_grid.QueryRadius(center, radius); }
+		std::vector<EntityId> QueryPoint(const Vector2f& point) const { return m_grid.QueryPoint(point); }
+
+	private:
+		SpatialGrid m_grid;
+		std::function<FloatRect(const BoundsComponentType&)> m_get_bounds;
+		std::uint32_t m_version = 0;
+		bool m_built = false;
+
+		void Apply(const std::vector<EntityId>& entities);
+	};
+
+	// Template Definitions
+
+	template <typename TestType>
+	void SpatialGrid::Search(const FloatRect& area, const TestType& test, std::vector<EntityId>& result) const {
+
+		auto visit = [&](std::uint32_t index) {
+			for (; index != NoEntry; index = m_entries[index].next)
+				if (test(m_entries[index].bounds))
+					result.push_back(m_entries[index].id);
+		};
+
+		visit(m_first_oversized);
+
+		// centers of entries not larger than a cell lie at most half a cell away from the area
+		const float margin = m_cell_size * 0.5f;
+
+		const int left   = GetCellCoordinate(area.left - margin);
+		const int top    = GetCellCoordinate(area.top - margin);
+		const int right  = GetCellCoordinate(area.left + area.width + margin);
+		const int bottom = GetCellCoordinate(area.top + area.height + margin);
+
+		if (right < left || bottom < top)
+			return;
+
+		const std::uint64_t cells = std::uint64_t(std::int64_t(right) - left + 1) * std::uint64_t(std::int64_t(bottom) - top + 1);
+
+		// large areas, walk through existing cells instead
+		if (cells > m_cell_count) {
+			for (const Cell& cell : m_cells) {
+				const int x = int(std::int32_t(cell.key >> 32));
+				const int y = int(std::int32_t(cell.key & 0xFFFFFFFF));
+
+				if (cell.used && x >= left && x <= right && y >= top && y <= bottom)
+					visit(cell.first);
+			}
+			return;
+		}
+
+		for (int y = top; y <= bottom; y++)
+			for (int x = left; x <= right; x++)
+				if (const Cell* cell = FindCell(GetCellKey(x, y)))
+					visit(cell->first);
+	}
+
+	template <typename BoundsComponentType>
+	SpatialIndex<BoundsComponentType>::SpatialIndex(float cell_size, const std::function<FloatRect(const BoundsComponentType&)>& get_bounds)
+		: m_grid(cell_size), m_get_bounds(get_bounds)
+	{
+		AE_ASSERT((std::is_base_of<Component, BoundsComponentType>::value), "Could not create spatial index, BoundsComponentType must inherit from Component");
+	}
+
+	template <typename BoundsComponentType>
+	void SpatialIndex<BoundsComponentType>::Update() {
+
+		const std::uint32_t version = EntityManager.GetChangeVersion<BoundsComponentType>();
+
+		// changes of a missed tick are lost, start over
+		if (!m_built || (version != m_version && version != m_version + 1)) {
+			Rebuild();
+			return;
+		}
+
+		// already up to date
+		if (version == m_version)
+			return;
+
+		Apply(EntityManager.GetRemovedEntities<BoundsComponentType>());
+		Apply(EntityManager.GetAddedEntities<BoundsComponentType>());
+		Apply(EntityManager.GetChangedEntities<BoundsComponentType>());
+
+		m_version = version;
+	}
+
+	template <typename BoundsComponentType>
+	void SpatialIndex<BoundsComponentType>::Rebuild() {
+		m_grid.Clear();
+
+		auto iterators = EntityManager.GetBeginEndIterators<BoundsComponentType>();
+		for (auto it = iterators.first; it != iterators.second; it++)
+			m_grid.Insert((*it)->GetEntity()->GetId(), m_get_bounds(*static_cast<const BoundsComponentType*>(*it)));
+
+		m_version = EntityManager.GetChangeVersion<BoundsComponentType>();
+		m_built = true;
+	}
+
+	template <typename BoundsComponentType>
+	void SpatialIndex<BoundsComponentType>::Apply(const std::vector<EntityId>& entities) {
+
+		// lists only tell what happened, the current state of an entity decides what to do
+		for (EntityId id : entities) {
+			Entity* entity = EntityManager.GetEntity(id);
+
+			if (entity && entity->HasComponent<BoundsComponentType>())
+				m_grid.Insert(id, m_get_bounds(entity->GetComponent<BoundsComponentType>()));
+			else
+				m_grid.Remove(id);
+		}
+	}
+}
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Statistics
+///
+///		EntityManager.GetStats() returns a summary of EntityManager's state, which can be logged or graphed:
+///		entities and groups, component types (counts, sizes and memory), advanced views (sizes, rebuilds, incremental updates, sorts),
+///		allocations of pools and the cost of Refresh.
+/// 
+///		Counters are always collected, they cost an increment per event. Refresh and rebuilds of advanced views (registration iterating through all entities)
+///		are timed every time, as they are rare compared to the work they do. Incremental updates of advanced views are frequent and cheap,
+///		they are timed only if the application was initialized with 'ecs_detailed_statistics' framework setting set to true.
+/// 
+///		GetStats allocates vectors describing component types and views, GetStats(stats) reuses the memory of a previous result,
+///		GetRefreshStats() returns a reference and costs nothing.
+/// 
+///		Advanced views are identified by their groups or component type ids, ComponentTypeStats maps the ids to type names.
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../../System/Time.hpp"
+#include "Utility.hpp"
+#include "ObjectPool.hpp"
+
+#include <vector>
+
+namespace ae {
+
+	struct ComponentTypeStats {
+		internal::ComponentTypeId id = 0;
+		const char* type_name = nullptr; // typeid(ComponentType).name()
+		size_t component_size = 0;       // sizeof(ComponentType)
+		size_t component_count = 0;
+		size_t dense_bytes = 0;          // memory of the vector used for iteration
+		PoolMemoryStats memory;
+	};
+
+	struct AdvancedViewStats {
+		bool is_group_view = true;
+
+		// tag of the view, groups for group views, component type ids for component views
+		std::vector<EntityGroup> groups, exclude_groups;
+		std::vector<internal::ComponentTypeId> components, exclude_components;
+
+		size_t entity_count = 0;
+		size_t reserved_bytes = 0;
+
+		size_t rebuild_count = 0; // rebuilds of the view, continued after eviction (as long as EntityManager remembers it) and reset by unregistering or Clear
+		Time last_rebuild_time;
+		size_t update_count = 0;  // entities inserted or erased incrementally since the last rebuild
+		Time update_time;         // total duration of incremental updates, measured only with 'ecs_detailed_statistics'
+		size_t sort_count = 0;
+		size_t idle_refresh_count = 0; // Refresh calls since the view was last used
+	};
+
+	struct RefreshStats {
+		size_t refresh_count = 0;
+		Time last_time, max_time, total_time;
+		size_t last_removed_entity_count = 0;
+		size_t last_played_command_count = 0;
+	};
+
+	struct EntityManagerStats {
+		size_t entity_count = 0; // killed ones included until Refresh
+		size_t group_count = 0;  // non-empty groups, AllEntitiesGroup included
+		PoolMemoryStats entity_memory;
+
+		std::vector<ComponentTypeStats> component_types;
+		std::vector<AdvancedViewStats> advanced_views;
+
+		size_t view_rebuild_count = 0;             // all rebuilds of advanced views since EntityManager was created
+		size_t failed_view_registration_count = 0; // registrations which found no entities, thus stored no view, though they iterated through all entities
+		size_t view_eviction_count = 0;            // advanced views unregistered for being unused, see 'ecs_advanced_view_max_age' and 'ecs_max_advanced_views'
+		size_t evicted_view_rebuild_count = 0;     // rebuilds of views evicted before, close to view_eviction_count when views are evicted while still needed
+		size_t allocation_count = 0;               // chunks allocated by entity and component pools, they are never freed until EntityManager is destroyed
+		size_t reserved_bytes = 0;                 // memory of pools, dense vectors and advanced views
+
+		RefreshStats refresh;
+	};
+}
@@ -0,0 +1,182 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////
+/// Systems
+///
+/// General Idea:
+///		System is an abstract class representing a piece of game logic run once per main loop iteration,
+///		after the active scene's Update and before drawing layers.
+///		Each system declares the component types it reads (Reads<ComponentTypes...>()) and writes (Writes<ComponentTypes...>()),
+///		preferably in its constructor.
+/// 
+/// Scheduling:
+///		Systems are kept in a queue, in the order of their creation (or the given position).
+///		Every iteration SystemScheduler builds a dependency graph from enabled systems, a system depends on each earlier system it conflicts with,
+///		two systems conflict if any of them writes a component type the other one reads or writes.
+///		Systems are then run in waves, systems of the same wave do not conflict and run in parallel on JobPool's threads (see JobPool.hpp).
+///		Exclusive systems (SetExclusive(true)) conflict with every other system, they always run alone on the main thread.
+///		A system declaring neither Reads nor Writes is treated as exclusive, so that a forgotten declaration does not run it concurrently with others.
+/// 
+///		Non-exclusive systems must not make structural changes to EntityManager (debug builds reject them, even if a system happens to run alone in its wave),
+///		entities can still be killed, other structural changes belong to exclusive systems.
+///		They must not register advanced views either, views used by them (ViewEntities, CountEntities with groups or ComponentPacks, etc.)
+///		have to be registered before SystemScheduler.Update (e.g. in the scene's Update or by an exclusive system), sorting also belongs to exclusive systems.
+///		With automatic eviction (see 'ecs_advanced_view_max_age' and 'ecs_max_advanced_views') Refresh can evict such a view,
+///		it then has to be registered again the same way.
+/// 
+/// Timing:
+///		GetUpdateTime() returns the duration of system's last Update,
+///		SystemScheduler.GetUpdateTime() returns the duration of the whole last Update.
+///
+//////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../../Core/Preprocessor.hpp"
+#include "../../Core/CreateStructure.hpp"
+#include "../../System/Time.hpp"
+
+#include "Utility.hpp"
+
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+namespace ae {
+
+	namespace internal {
+		class SystemSchedulerType;
+	}
+
+	class System {
+		friend class internal::SystemSchedulerType;
+
+	public:
+		System() {}
+		virtual ~System() {}
+
+		virtual void Update() = 0;
+
+		void SetEnabled(bool enabled) { m_enabled = enabled; }
+		bool IsEnabled() const { return m_enabled; }
+
+		// systems which declared no component access are exclusive as well
+		bool IsExclusive() const { return m_exclusive || (m_reads.none() && m_writes.none()); }
+
+		const Time& GetUpdateTime() const { return m_update_time; }
+
+	protected:
+		template <typename ...ComponentTypes>
+		void Reads() {
+			(m_reads.set(internal::GetComponentTypeId<typename std::remove_const<ComponentTypes>::type>()), ...);
+		}
+
+		template <typename ...ComponentTypes>
+		void Writes() {
+			(m_writes.set(internal::GetComponentTypeId<typename std::remove_const<ComponentTypes>::type>()), ...);
+		}
+
+		void SetExclusive(bool exclusive) { m_exclusive = exclusive; }
+
+	private:
+		internal::ComponentSignature m_reads, m_writes;
+		bool m_enabled = true;
+		bool m_exclusive = false;
+
+		Time m_update_time;
+	};
+
+	namespace internal {
+
+		class ApplicationType;
+
+		class SystemSchedulerType {
+			friend class ae::internal::ApplicationType;
+
+			template <typename SingletonType>
+			friend SingletonType ae::internal::CreateStructure<SystemSchedulerType>();
+
+		public:
+			~SystemSchedulerType();
+
+			template <typename SystemType, typename ...ArgsType>
+			SystemType& CreateSystem(ArgsType&&... args) {
+				SystemType* system = new SystemType(std::forward<ArgsType>(args)...);
+				m_systems.push_back(system);
+				return *system;
+			}
+
+			template <typename SystemType, typename ...ArgsType>
+			SystemType& CreateSystem(size_t position, ArgsType&&... args) {
+				AE_ASSERT(position <= GetSize(), "Could not create system on position '" << position << "', vector out of range");
+
+				SystemType* system = new SystemType(std::forward<ArgsType>(args)...);
+				m_systems.insert(m_systems.begin() + position, system);
+				return *system;
+			}
+
+			System& GetSystem(size_t position) const;
+			size_t GetSize() const;
+
+			void RemoveSystem(size_t position);
+			void RemoveSystem(System& system);
+			void RemoveAllSystems();
+
+			void Update();
+
+			const Time& GetUpdateTime() const;
+			size_t GetWaveCount() const;
+
+		private:
+			std::vector<System*> m_systems;
+
+			// rebuilt every update, kept to reuse memory
+			std::vector<size_t> m_levels;
+			std::vector<std::vector<System*>> m_waves;
+			std::vector<std::function<void()>> m_jobs;
+			size_t m_wave_count = 0;
+
+			Time m_update_time;
+
+			SystemSchedulerType() = default;
+			SystemSchedulerType(const SystemSchedulerType&) = delete;
+			SystemSchedulerType(SystemSchedulerType&&) = delete;
+
+			static bool Conflict(const System& system1, const System& system2);
+			static void RunSystem(System& system);
+
+			void BuildWaves();
+		};
+	}
+
+	extern ae::internal::SystemSchedulerType SystemScheduler;
+}
@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Transform Hierarchy
+///
+///		TransformHierarchy combines local transforms of entities with those of their parents into world matrices.
+///		Each node refers to a Transform2D, which is not copied, thus it has to outlive the node. Nodes are identified by EntityId and every node can have one parent.
+///		A world matrix is 'parent's world matrix * local matrix', matrices are expected to be affine, which is the case for Transform2D.
+/// 
+///		Update() recomputes world matrices of nodes marked dirty and of all their descendants, nothing else is touched,
+///		if no node is dirty it returns immediately. After a local transform has been modified, MarkDirty has to be called.
+///		Nodes are kept in breadth-first order (sorted by depth) and world matrices in a structure of arrays, each level is processed in a single pass,
+///		which reads parents' matrices computed by the previous one. Levels larger than 'grain' are split into chunks processed on JobPool's threads.
+///		Inserting, removing and reparenting nodes only records the change, nodes are reordered once by the next Update.
+///		Children of a removed node become roots, their world matrices become their local matrices.
+///		World matrices are valid after Update, GetWorldMatrix returns the last computed one.
+/// 
+///		TransformComponent is an ECS component which owns a local Transform2D and registers its entity in a TransformHierarchy, which must outlive the component.
+///		The transform is modified through ModifyLocal(), which marks it dirty. The entity is removed from the hierarchy together with the component.
+/// 
+///		Usage:
+///			ae::TransformHierarchy hierarchy;
+///			
+///			ae::Entity& ship = ae::EntityManager.CreateEntity();
+///			ship.AddComponent<ae::TransformComponent>(hierarchy);
+///			
+///			ae::Entity& turret = ae::EntityManager.CreateEntity();
+///			turret.AddComponent<ae::TransformComponent>(hierarchy, ship.GetId()).ModifyLocal().SetPosition(ae::Vector2f(10.f, 0.f));
+///			
+///			ship.GetComponent<ae::TransformComponent>().ModifyLocal().Rotate(5.f);
+///			hierarchy.Update();
+///			ae::Vector2f turret_position = turret.GetComponent<ae::TransformComponent>().TransformPoint(ae::Vector2f());
+/// 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../../Graphics/Transform2D.hpp"
+#include "../../Graphics/Matrix3x3.hpp"
+#include "../../System/Vector2.hpp"
+
+#include "Utility.hpp"
+#include "Component.hpp"
+
+#include <vector>
+#include <cstdint>
+
+namespace ae {
+
+	class TransformHierarchy {
+	public:
+		TransformHierarchy() = default;
+		TransformHierarchy(const TransformHierarchy&) = delete;
+		TransformHierarchy(TransformHierarchy&&) = delete;
+
+		// parent has to be in the hierarchy already, InvalidEntityId makes a root
+		void Insert(EntityId entity, const Transform2D& local, EntityId parent = InvalidEntityId);
+		void Remove(EntityId entity);
+		void Clear();
+
+		bool Contains(EntityId entity) const;
+		size_t CountNodes() const { return m_ids.size(); }
+
+		// parent cannot be the entity itself nor its descendant
+		void SetParent(EntityId entity, EntityId parent);
+		EntityId GetParent(EntityId entity) const;
+
+		void MarkDirty(EntityId entity);
+		void Update(size_t grain = 4096);
+
+		Matrix3x3 GetWorldMatrix(EntityId entity) const;
+		Vector2f TransformPoint(EntityId entity, const Vector2f& point) const;
+
+	private:
+		static constexpr std::uint32_t NoNode = 0xFFFFFFFF;
+
+		struct Slot {
+			EntityId id = InvalidEntityId;
+			EntityId parent = InvalidEntityId;
+			std::uint32_t position = NoNode;
+		};
+		std::vector<Slot> m_slots; // indexed by EntityId::index
+
+		// nodes, element i of every array belongs to the node at position i
+		std::vector<EntityId> m_ids;
+		std::vector<std::uint32_t> m_parents; // positions of parents, valid while ordered
+		std::vector<const Transform2D*> m_locals;
+		std::vector<std::uint8_t> m_dirty;
+
+		// world matrices, named after Matrix3x3's constructor, the last row is always (0, 0, 1)
+		std::vector<float> m_world_00, m_world_10, m_world_20;
+		std::vector<float> m_world_01, m_world_11, m_world_21;
+
+		// breadth-first order, nodes of depth d end at m_level_ends[d]
+		std::vector<std::uint32_t> m_level_ends;
+		bool m_ordered = true;
+		size_t m_first_dirty = NoNode; // while ordered, no node before it is dirty
+
+		const Slot* FindSlot(EntityId entity) const;
+		bool IsAncestor(EntityId ancestor, EntityId entity) const;
+
+		void PushNode(EntityId entity, const Transform2D* local);
+		void Reorder();
+		void UpdateRange(size_t begin, size_t end);
+	};
+
+	class TransformComponent : public Component {
+	public:
+		TransformComponent(TransformHierarchy& hierarchy, EntityId parent = InvalidEntityId) : m_hierarchy(&hierarchy), m_parent(parent) {}
+		~TransformComponent();
+
+		virtual void Initialize() override;
+
+		// marks the transform dirty
+		Transform2D& ModifyLocal();
+		const Transform2D& GetLocal() const { return m_local; }
+
+		void SetParent(EntityId parent);
+		EntityId GetParent() const;
+
+		Matrix3x3 GetWorldMatrix() const;
+		Vector2f TransformPoint(const Vector2f& point) const;
+
+	private:
+		TransformHierarchy* m_hierarchy;
+		Transform2D m_local;
+		EntityId m_parent; // used until the component is initialized
+		EntityId m_id = InvalidEntityId;
+	};
+}
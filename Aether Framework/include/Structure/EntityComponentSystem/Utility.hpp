@@ -32,17 +32,24 @@
 
 #pragma once
 
-#include <typeindex>
+#include "../../Core/Preprocessor.hpp"
+
+#include <bitset>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+
+// maximum number of component types, each one takes a bit of entity's signature
+#ifndef AE_ECS_MAX_COMPONENT_TYPES
+	#define AE_ECS_MAX_COMPONENT_TYPES 64
+#endif
 
 #define AE_ECS_ADVANCED_COMP_VIEW_DEBUG_LOGIC_TEST(include, exclude, invalid_size_message, share_element_message) \
  \
 	AE_DEBUG_ONLY ( \
-		AE_ASSERT(include.size() > 1 || exclude.size() > 0, invalid_size_message); \
- \
-		for (auto& include_element : include) \
-			if (std::find(exclude.begin(), exclude.end(), include_element) != exclude.end()) { \
-				AE_ASSERT_FALSE(share_element_message); \
-			} \
+		AE_ASSERT(include.count() > 1 || exclude.count() > 0, invalid_size_message); \
+		AE_ASSERT((include & exclude).none(), share_element_message); \
 	);
 
 #define AE_ECS_ADVANCED_GROUP_VIEW_DEBUG_LOGIC_TEST(include, exclude, invalid_size_message, share_element_message) \
@@ -52,14 +59,58 @@
 			"groups and exclude_groups cannot possess AllEntitiesGroup (index 0)" \
 		); \
 		 \
-		AE_ECS_ADVANCED_COMP_VIEW_DEBUG_LOGIC_TEST(include, exclude, invalid_size_message, share_element_message) \
+		AE_ASSERT(include.size() > 1 || exclude.size() > 0, invalid_size_message); \
+ \
+		for (auto& include_element : include) \
+			if (std::find(exclude.begin(), exclude.end(), include_element) != exclude.end()) { \
+				AE_ASSERT_FALSE(share_element_message); \
+			} \
 	);
 
 namespace ae {
 	namespace internal { 
-		typedef std::type_index ComponentTypeId;
+
+		// Dense component type ids, assigned once per type at its first use
+		typedef std::uint32_t ComponentTypeId;
+		typedef std::bitset<AE_ECS_MAX_COMPONENT_TYPES> ComponentSignature;
+
+		inline ComponentTypeId GenerateComponentTypeId() {
+			static std::atomic<ComponentTypeId> next_id(0);
+
+			ComponentTypeId id = next_id++;
+			AE_ASSERT(id < AE_ECS_MAX_COMPONENT_TYPES, "Too many component types, define AE_ECS_MAX_COMPONENT_TYPES with a value greater than " << AE_ECS_MAX_COMPONENT_TYPES);
+
+			return id;
+		}
+
+		template <typename ComponentType>
+		ComponentTypeId GetComponentTypeId() {
+			static const ComponentTypeId id = GenerateComponentTypeId();
+			return id;
+		}
 	} 
 
 	typedef size_t EntityGroup;
 	constexpr EntityGroup AllEntitiesGroup = 0;
+
+	// Generational handle of an entity, index points to a slot in EntityManager and generation detects reused slots
+	struct EntityId {
+		std::uint32_t index = 0xFFFFFFFF;
+		std::uint32_t generation = 0;
+
+		bool operator==(const EntityId& other) const { return (index == other.index && generation == other.generation); }
+		bool operator!=(const EntityId& other) const { return !(*this == other); }
+		bool operator<(const EntityId& other) const { return (index == other.index) ? (generation < other.generation) : (index < other.index); }
+
+		std::uint64_t GetValue() const { return (std::uint64_t(generation) << 32) | index; }
+	};
+
+	constexpr EntityId InvalidEntityId = EntityId();
+}
+
+namespace std {
+	template <>
+	struct hash<ae::EntityId> {
+		size_t operator()(const ae::EntityId& id) const { return std::hash<std::uint64_t>()(id.GetValue()); }
+	};
 }
\ No newline at end of file
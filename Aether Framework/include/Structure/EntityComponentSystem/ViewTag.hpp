@@ -33,6 +33,7 @@
 #pragma once
 
 #include "Utility.hpp"
+#include "GroupSet.hpp"
 #include "Component.hpp"
 
 #include "../../Core/Preprocessor.hpp"
@@ -46,40 +47,39 @@ namespace ae {
 
 		struct GroupTag {
 
-			std::set<EntityGroup> include;
-			std::set<EntityGroup> exclude;
+			GroupSet include;
+			GroupSet exclude;
 
 			bool operator==(const GroupTag& other) const;
 			bool operator!=(const GroupTag& other) const;
 
-			bool IsCompatible(const std::vector<EntityGroup>& groups) const;
+			bool IsCompatible(const GroupSet& groups) const { return (groups.Includes(include) && !groups.Intersects(exclude)); }
 
 			struct Hash {
 				size_t operator()(const GroupTag& tag) const;
 			};
 
 			GroupTag() = default;
-			GroupTag(const std::set<EntityGroup>& include, const std::set<EntityGroup>& exclude)
-				: include(include), exclude(exclude) {}
+			GroupTag(const std::set<EntityGroup>& include, const std::set<EntityGroup>& exclude);
 				
 		};
 
 		struct ComponentTag {
 
-			std::set<ComponentTypeId> include;
-			std::set<ComponentTypeId> exclude;
+			ComponentSignature include;
+			ComponentSignature exclude;
 
 			bool operator==(const ComponentTag& other) const;
 			bool operator!=(const ComponentTag& other) const;
 
-			bool IsCompatible(const std::vector<Component*>& components) const;
+			bool IsCompatible(const ComponentSignature& signature) const { return ((signature & include) == include && (signature & exclude).none()); }
 
 			struct Hash {
 				size_t operator()(const ComponentTag& tag) const;
 			};
 
 			ComponentTag() = default;
-			ComponentTag(const std::set<ComponentTypeId>& include, const std::set<ComponentTypeId>& exclude)
+			ComponentTag(const ComponentSignature& include, const ComponentSignature& exclude)
 				: include(include), exclude(exclude) {}
 
 		};
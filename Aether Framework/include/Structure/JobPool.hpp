@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////
+/// Job Pool
+///
+/// General Idea:
+///		JobPool is the framework-owned pool of worker threads used to run work in parallel (for example parallel entity views).
+///		Worker threads are created lazily on first use, their count is defined by 'job_pool_worker_count' framework setting
+///		(0 - one less than the number of hardware threads), the thread calling the pool always takes part in the work.
+/// 
+/// Work Stealing:
+///		Each worker owns a queue of jobs, it takes jobs from the front of its own queue
+///		and steals jobs from the back of other queues when its own is empty.
+/// 
+/// ParallelFor:
+///		Splits range [0, count) into chunks of 'grain' elements and returns once every chunk has been processed.
+///		Chunk boundaries depend only on count and grain ([i * grain, min((i + 1) * grain, count))), never on the number of threads,
+///		operations called for the same chunk can run on any thread though.
+///		ParallelFor can be called from inside a job.
+///		If operations throw, the remaining chunks are still processed, then the first exception is rethrown on the calling thread.
+/// 
+/// Run:
+///		Runs every given job (possibly in parallel) and returns once all of them have finished.
+///
+//////////////////////////////////////////////////////////////
+#pragma once
+
+#include "../Core/CreateStructure.hpp"
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+namespace ae {
+	namespace internal {
+
+		class JobPoolType {
+			template <typename SingletonType>
+			friend SingletonType ae::internal::CreateStructure<JobPoolType>();
+
+			friend class ApplicationType;
+
+		public:
+			~JobPoolType() { Terminate(); }
+
+			void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& operation);
+			void Run(const std::vector<std::function<void()>>& jobs);
+
+			size_t GetThreadCount(); // workers + calling thread
+			bool IsWorkerThread() const;
+
+		private:
+			// state of one ParallelFor, shared by its jobs and owned by the calling thread until every job has finished
+			struct Batch {
+				const std::function<void(size_t, size_t)>* operation = nullptr;
+				std::atomic<size_t> remaining = 0;
+
+				std::mutex error_mutex;
+				std::exception_ptr error; // first exception thrown by a chunk
+			};
+
+			struct Job {
+				Batch* batch = nullptr;
+				size_t begin = 0, end = 0;
+			};
+
+			struct Worker {
+				std::mutex mutex;
+				std::deque<Job> jobs;
+				std::thread thread;
+			};
+
+			std::vector<std::unique_ptr<Worker>> m_workers;
+			std::atomic<size_t> m_queued_jobs = 0;
+			std::atomic<size_t> m_next_worker = 0;
+
+			std::mutex m_start_mutex;
+			std::atomic<bool> m_started = false;
+			bool m_stop = false;
+
+			std::mutex m_sleep_mutex;
+			std::condition_variable m_wake;
+
+			JobPoolType() = default;
+			JobPoolType(const JobPoolType&) = delete;
+			JobPoolType(JobPoolType&&) = delete;
+
+			void Start();
+			void Terminate();
+
+			void WorkerLoop(size_t index);
+			bool PopJob(size_t first_queue, Job& job);
+			void Execute(const Job& job);
+		};
+	}
+
+	extern internal::JobPoolType JobPool;
+}
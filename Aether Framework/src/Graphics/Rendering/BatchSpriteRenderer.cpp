@@ -58,17 +58,26 @@ namespace ae {
 	}
 
 	BatchSpriteRenderer& BatchSpriteRenderer::operator=(const BatchSpriteRenderer& copy) {
+		if (this == &copy)
+			return *this;
+
 		m_texture = copy.m_texture;
 		m_vertices = copy.m_vertices;
 		m_transforms = copy.m_transforms;
+		m_storage_buffer_usage = copy.m_storage_buffer_usage;
+		m_dirty_transforms.AddAll();
+		m_pending_destruction_count = copy.m_pending_destruction_count;
 
-		// copy batches
+		// copy batches, previous handles and free batch objects are dropped
+		m_batches.clear();
+		m_free_batches.clear();
 		m_batches.reserve(copy.m_batches.size());
 
 		for (auto& batch_uptr : copy.m_batches) {
 			BatchSprite* batch = new BatchSprite();
 			batch->m_renderer = this;
 			batch->m_index = batch_uptr.get()->m_index;
+			batch->m_pending_destruction = batch_uptr->m_pending_destruction;
 
 			m_batches.emplace_back(batch);
 		}
@@ -80,6 +89,11 @@ namespace ae {
 		m_vertices = std::move(move.m_vertices);
 		m_transforms = std::move(move.m_transforms);
 		m_batches = std::move(move.m_batches);
+		m_free_batches = std::move(move.m_free_batches);
+		m_pending_destruction_count = move.m_pending_destruction_count;
+		m_storage_buffer_usage = move.m_storage_buffer_usage;
+		m_dirty_transforms = move.m_dirty_transforms;
+		m_transform_buffer = std::move(move.m_transform_buffer);
 
 		for (auto& batch_uptr : m_batches)
 			batch_uptr->m_renderer = this;
@@ -89,7 +103,10 @@ namespace ae {
 
 	
 	void BatchSpriteRenderer::Draw(const Matrix3x3& transform) const {
-		Draw(ae::DefaultAssets->batch_sprite_shader, transform);
+		if (IsStorageBufferUsed())
+			Draw(ae::DefaultAssets->batch_sprite_storage_shader, transform);
+		else
+			Draw(ae::DefaultAssets->batch_sprite_shader, transform);
 	}
 	void BatchSpriteRenderer::Draw(const Shader& shader, const Matrix3x3& transform) const {
 		shader.Bind();
@@ -103,6 +120,30 @@ namespace ae {
 		shader.SetUniform.Sampler2D("u_texture", 0);
 
 		m_vertices.Bind();
+
+		// single draw call, transforms are read from the storage buffer
+		if (IsStorageBufferUsed()) {
+			if (GetCount() == 0)
+				return;
+
+			static_assert(sizeof(Matrix3x3) == 9 * sizeof(float), "Matrix3x3 has to be tightly packed to be copied to the storage buffer");
+
+			// reallocated buffer loses its content
+			if (m_transform_buffer.Reserve(sizeof(Matrix3x3) * GetCount()))
+				m_dirty_transforms.AddAll();
+
+			m_dirty_transforms.ForEach(GetCount(), [this](size_t first, size_t last) {
+				m_transform_buffer.UpdateRange(sizeof(Matrix3x3) * first, sizeof(Matrix3x3) * (last - first), m_transforms.data() + first);
+			});
+
+			m_dirty_transforms.Clear();
+
+			m_transform_buffer.BindBase(0);
+			m_vertices.Draw(0, GetCount() * 6);
+			return;
+		}
+
+		// uniform chunks
 		size_t max_draws_per_call = DefaultAssets->batch_sprite_max_draws_per_call;
 
 		for (size_t drawn_batches(0); drawn_batches < GetCount(); drawn_batches += max_draws_per_call) {
@@ -121,12 +162,26 @@ namespace ae {
 		draw(m_texture, GetCount(), m_transforms, m_vertices);
 	}
 	BatchSprite& BatchSpriteRenderer::CreateBack(const Matrix3x3& transform) {
-		BatchSprite* batch = m_batches.emplace_back(new BatchSprite()).get();
+		Compact();
+
+		// reuse destroyed batch objects
+		if (m_free_batches.empty()) {
+			m_batches.emplace_back(new BatchSprite());
+		}
+		else {
+			m_batches.emplace_back(std::move(m_free_batches.back()));
+			m_free_batches.pop_back();
+		}
+
+		BatchSprite* batch = m_batches.back().get();
 
 		batch->m_renderer = this;
 		batch->m_index = GetCount() - 1;
+		batch->m_pending_destruction = false;
 
 		m_transforms.emplace_back(transform);
+		m_dirty_transforms.Add(GetCount() - 1, GetCount());
+
 		unsigned int i = m_vertices.GetVertices().size();
 		m_vertices.Append(
 			{
@@ -148,83 +203,153 @@ namespace ae {
 		Destroy(batch.m_index);
 	}
 	void BatchSpriteRenderer::Destroy(size_t index) {
-		m_transforms.erase(m_transforms.begin() + index);
-		m_batches.erase(m_batches.begin() + index);
+		if (m_batches[index]->m_pending_destruction)
+			m_pending_destruction_count--;
 
-		// update vertices
-		m_vertices.EraseVertices(index * 4, index * 4 + 3);
-		
-		// update indices
-		auto& indices = m_vertices.GetCPUIndices();
-		m_vertices.EnsureSizeUpdate();
+		// the last batch takes destroyed one's place
+		size_t last = GetCount() - 1;
+
+		if (index != last) {
+			auto& vertices = m_vertices.GetCPUVertices();
+			std::copy_n(vertices.begin() + last * 4, 4, vertices.begin() + index * 4);
+			m_vertices.EnsureVerticesUpdate(index * 4, index * 4 + 3);
+
+			m_transforms[index] = m_transforms[last];
+			m_dirty_transforms.Add(index, index + 1);
+
+			std::swap(m_batches[index], m_batches[last]);
+			m_batches[index]->m_index = index;
+		}
 
-		indices.erase(indices.begin() + (index * 6), indices.begin() + (index + 1) * 6);
+		// drop the last quad, indices of remaining quads do not change
+		m_transforms.pop_back();
+		m_free_batches.emplace_back(std::move(m_batches.back()));
+		m_batches.pop_back();
 
-		for (size_t i(index * 6); i < indices.size(); i++)
-			indices.at(i) -= 4;
+		m_vertices.EraseVertices(last * 4, last * 4 + 3);
+		m_vertices.EraseIndices(last * 6, last * 6 + 5);
+	}
 
-		// update other batches' positions
-		for (size_t i(index); i < GetCount(); i++)
-			m_batches.at(i)->m_index--;
+	void BatchSpriteRenderer::DestroyLater(BatchSprite& batch) {
+		DestroyLater(batch.m_index);
+	}
+	void BatchSpriteRenderer::DestroyLater(size_t index) {
+		BatchSprite& batch = *m_batches[index];
+
+		if (batch.m_pending_destruction)
+			return;
+
+		batch.m_pending_destruction = true;
+		m_pending_destruction_count++;
+
+		// degenerate quad is not drawn
+		auto& vertices = m_vertices.GetCPUVertices();
+
+		for (size_t i = index * 4; i < index * 4 + 4; i++)
+			vertices[i].position = Vector2f();
+
+		m_vertices.EnsureVerticesUpdate(index * 4, index * 4 + 3);
+	}
+	void BatchSpriteRenderer::Compact() {
+		if (m_pending_destruction_count == 0)
+			return;
+
+		// stable pass moving remaining batches to the front
+		auto& vertices = m_vertices.GetCPUVertices();
+		size_t kept = 0;
+		size_t first_moved = GetCount();
+
+		for (size_t i = 0; i < GetCount(); i++) {
+			if (m_batches[i]->m_pending_destruction) {
+				m_free_batches.emplace_back(std::move(m_batches[i]));
+				continue;
+			}
+
+			if (kept != i) {
+				std::copy_n(vertices.begin() + i * 4, 4, vertices.begin() + kept * 4);
+				m_transforms[kept] = m_transforms[i];
+
+				m_batches[kept] = std::move(m_batches[i]);
+				m_batches[kept]->m_index = kept;
+
+				first_moved = std::min(first_moved, kept);
+			}
+
+			kept++;
+		}
+
+		// drop quads from the back, indices of remaining quads do not change
+		m_vertices.EraseVertices(kept * 4, vertices.size() - 1);
+		m_vertices.EraseIndices(kept * 6, m_vertices.GetIndices().size() - 1);
+
+		if (first_moved < kept) {
+			m_vertices.EnsureVerticesUpdate(first_moved * 4, kept * 4 - 1);
+			m_dirty_transforms.Add(first_moved, kept);
+		}
+
+		m_batches.resize(kept);
+		m_transforms.resize(kept);
+		m_pending_destruction_count = 0;
 	}
 	void BatchSpriteRenderer::Clear() {
+		for (auto& batch_uptr : m_batches)
+			m_free_batches.emplace_back(std::move(batch_uptr));
+
 		m_batches.clear();
 		m_transforms.clear();
+		m_dirty_transforms.Clear();
+		m_pending_destruction_count = 0;
 		m_vertices.Clear();
 	}
 
 	void BatchSpriteRenderer::Sort(const std::function<bool(const BatchSprite& left, const BatchSprite& right)>& compare) {
+		Compact();
 
-		// batches, transforms and vertices are sort
-		// vertex indices stay as they are
-
-		// reinterpret vertices array as quads array
-		std::vector<QuadVertices>& quad_vertices = 
-			reinterpret_cast<std::vector<QuadVertices>&>(
-				m_vertices.GetCPUVertices()
-			);
-
-		m_vertices.EnsureSizeUpdate();
+		// insertion sort batches' order
+		std::vector<std::uint32_t> order(GetCount());
+		std::iota(order.begin(), order.end(), 0);
 
-		// insertion sort batches
-		for (int marker = 1; marker < m_batches.size(); marker++) {
+		for (size_t marker = 1; marker < order.size(); marker++) {
 
-			std::unique_ptr<BatchSprite> batch = std::move(m_batches[marker]);
-			int sub_marker = marker - 1;
+			std::uint32_t index = order[marker];
+			std::ptrdiff_t sub_marker = static_cast<std::ptrdiff_t>(marker) - 1;
 
-			while (sub_marker >= 0 && compare(*m_batches[sub_marker], *batch)) {
-				m_batches[sub_marker + 1] = std::move(m_batches[sub_marker]);
+			while (sub_marker >= 0 && compare(*m_batches[order[sub_marker]], *m_batches[index])) {
+				order[sub_marker + 1] = order[sub_marker];
 
 				sub_marker--;
 			}
-			m_batches[sub_marker + 1] = std::move(batch);
+			order[sub_marker + 1] = index;
 		}
 
-		// create new order and update batches' m_index
-		std::vector<size_t> new_order;
-		new_order.reserve(GetCount());
-		for (size_t i(0); i < GetCount(); i++) {
-			BatchSprite& batch = *m_batches.at(i);
+		Reorder(order);
+	}
+	void BatchSpriteRenderer::Reorder(const std::vector<std::uint32_t>& order) {
 
-			new_order.push_back(batch.m_index);
-			batch.m_index = i;
-		}
-		
-		// safely reorder stuff by new order
-		for (size_t i = 0; i < GetCount() - 1; i++) {
-			if (new_order[i] == i)
-				continue;
+		// batches, transforms and vertices are sort
+		// vertex indices stay as they are
 
-			size_t o;
-			for (o = i + 1; o < new_order.size(); ++o)
-				if (new_order[o] == i)
-					break;
+		// check if anything has moved
+		size_t first_moved = 0;
+		while (first_moved < order.size() && order[first_moved] == first_moved)
+			first_moved++;
 
-			std::swap(m_transforms[i], m_transforms[new_order[i]]);
-			std::swap(quad_vertices[i], quad_vertices[new_order[i]]);
+		if (first_moved == order.size())
+			return;
 
-			std::swap(new_order[i], new_order[o]);
-		}
+		// reinterpret vertices array as quads array
+		QuadVertices* quad_vertices = reinterpret_cast<QuadVertices*>(m_vertices.GetCPUVertices().data());
+
+		m_vertices.EnsureVerticesUpdate(first_moved * 4, GetCount() * 4 - 1);
+
+		// move everything in linear time and update batches' m_index
+		internal::ApplySortOrder(m_batches.data(), order);
+		internal::ApplySortOrder(m_transforms.data(), order);
+		m_dirty_transforms.Add(first_moved, GetCount());
+		internal::ApplySortOrder(quad_vertices, order);
+
+		for (size_t i = 0; i < GetCount(); i++)
+			m_batches[i]->m_index = i;
 	}
 
 	void BatchSpriteRenderer::SetTexture(const Texture& texture) {
@@ -234,18 +359,43 @@ namespace ae {
 		m_texture = &texture;
 	}
 
+	void BatchSpriteRenderer::SetStorageBufferUsage(bool use) {
+		m_storage_buffer_usage = use;
+	}
+	bool BatchSpriteRenderer::IsStorageBufferUsed() const {
+		return m_storage_buffer_usage && DefaultAssets->batch_sprite_storage_supported;
+	}
+
+	void BatchSpriteRenderer::SetVertexBufferMode(VertexBufferMode mode) {
+		m_vertices.SetBufferMode(mode);
+	}
+	VertexBufferMode BatchSpriteRenderer::GetVertexBufferMode() const {
+		return m_vertices.GetBufferMode();
+	}
+
 	BatchSprite& BatchSpriteRenderer::Get(size_t index) const { return *m_batches[index]; }
 	size_t BatchSpriteRenderer::GetCount() const { return m_batches.size(); }
 	const Texture* BatchSpriteRenderer::GetTexture() const { return m_texture; }
 
 	void BatchSprite::SetTransform(const Matrix3x3& transform) {
+		if (m_pending_destruction) {
+			AE_WARNING("Could not set transform, BatchSprite is pending destruction");
+			return;
+		}
+
 		m_renderer->m_transforms.at(m_index) = transform;
+		m_renderer->m_dirty_transforms.Add(m_index, m_index + 1);
 	}
 	const Matrix3x3& BatchSprite::GetTransform() const {
 		return m_renderer->m_transforms.at(m_index);
 	}
 
 	void BatchSprite::SetSize(const Vector2f& size) {
+		if (m_pending_destruction) {
+			AE_WARNING("Could not set size, BatchSprite is pending destruction");
+			return;
+		}
+
 		auto& vertex_array = m_renderer->m_vertices;
 		const auto& vertices = vertex_array.GetVertices();
 		size_t vertex_index = m_index * 4;
@@ -269,6 +419,11 @@ namespace ae {
 	}
 
 	void BatchSprite::SetColors(const Color& v0, const Color& v1, const Color& v2, const Color& v3) {
+		if (m_pending_destruction) {
+			AE_WARNING("Could not set colors, BatchSprite is pending destruction");
+			return;
+		}
+
 		size_t index = m_index * 4;
 		
 		auto& vertex_array = m_renderer->m_vertices;
@@ -310,6 +465,11 @@ namespace ae {
 	}
 
 	void BatchSprite::SetTextureRect(const IntRect& rect){
+		if (m_pending_destruction) {
+			AE_WARNING("Could not set texture rect, BatchSprite is pending destruction");
+			return;
+		}
+
 		size_t index = m_index * 4;
 
 		auto& vertex_array = m_renderer->m_vertices;
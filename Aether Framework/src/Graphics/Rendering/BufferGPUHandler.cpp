@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Graphics/Rendering/BufferGPUHandler.hpp"
+#include "Core/OpenGLCalls.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace ae {
+	namespace internal {
+
+		BufferGPUHandler::BufferGPUHandler(std::uint32_t gl_target)
+			: m_target(gl_target)
+		{
+			AE_GL_LOG(glGenBuffers(1, &m_buffer_id));
+		}
+		BufferGPUHandler::BufferGPUHandler(const BufferGPUHandler& copy)
+			: m_target(copy.m_target)
+		{
+			AE_GL_LOG(glGenBuffers(1, &m_buffer_id));
+			CopyFrom(copy);
+		}
+		BufferGPUHandler::BufferGPUHandler(BufferGPUHandler&& move) noexcept {
+			MoveFrom(std::move(move));
+		}
+		BufferGPUHandler::~BufferGPUHandler() {
+			AE_GL_LOG(glDeleteBuffers(1, &m_buffer_id));
+		}
+
+		void BufferGPUHandler::operator=(const BufferGPUHandler& copy) {
+			CopyFrom(copy);
+		}
+		void BufferGPUHandler::operator=(BufferGPUHandler&& move) noexcept {
+			AE_GL_LOG(glDeleteBuffers(1, &m_buffer_id));
+			MoveFrom(std::move(move));
+		}
+
+		void BufferGPUHandler::CopyFrom(const BufferGPUHandler& copy) {
+			m_target = copy.m_target;
+			m_byte_capacity = 0;
+
+			Reserve(copy.m_byte_capacity);
+
+			if (copy.m_byte_capacity == 0)
+				return;
+
+			AE_GL_LOG(glBindBuffer(GL_COPY_READ_BUFFER, copy.m_buffer_id));
+			AE_GL_LOG(glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer_id));
+			AE_GL_LOG(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copy.m_byte_capacity));
+		}
+		void BufferGPUHandler::MoveFrom(BufferGPUHandler&& move) noexcept {
+			m_buffer_id = move.m_buffer_id;
+			m_target = move.m_target;
+			m_byte_capacity = move.m_byte_capacity;
+
+			move.m_buffer_id = 0;
+			move.m_byte_capacity = 0;
+		}
+
+		void BufferGPUHandler::Bind() const {
+			AE_GL_LOG(glBindBuffer(m_target, m_buffer_id));
+		}
+		void BufferGPUHandler::BindBase(std::uint32_t binding) const {
+			AE_GL_LOG(glBindBufferBase(m_target, binding, m_buffer_id));
+		}
+
+		void BufferGPUHandler::AddInstanceAttribute(std::uint32_t location, const VertexAttributeTypeInfo& ati, bool normalize, size_t byte_size, size_t byte_offset) const {
+			AE_ASSERT(VertexArrayGPUHandler::s_bound_vao_id != 0, "Vertex array must be bound before adding instance attributes");
+
+			AE_GL_LOG(glBindBuffer(GL_ARRAY_BUFFER, m_buffer_id));
+			AE_GL_LOG(glVertexAttribPointer(location, ati.component_count, ati.gl_type, normalize, byte_size, reinterpret_cast<void*>(byte_offset)));
+			AE_GL_LOG(glEnableVertexAttribArray(location));
+			AE_GL_LOG(glVertexAttribDivisor(location, 1));
+		}
+
+		bool BufferGPUHandler::Reserve(size_t byte_size) {
+			if (byte_size <= m_byte_capacity)
+				return false;
+
+			m_byte_capacity = std::max(byte_size, m_byte_capacity * 2);
+
+			AE_GL_LOG(glBindBuffer(m_target, m_buffer_id));
+			AE_GL_LOG(glBufferData(m_target, m_byte_capacity, NULL, GL_DYNAMIC_DRAW));
+
+			VertexArrayGPUHandler::s_upload_stats.reallocation_count++;
+			return true;
+		}
+
+		void BufferGPUHandler::Update(size_t byte_size, const void* data) {
+			Reserve(byte_size);
+			UpdateRange(0, byte_size, data);
+		}
+		void BufferGPUHandler::UpdateRange(size_t byte_offset, size_t byte_size, const void* data) const {
+			AE_ASSERT(byte_offset + byte_size <= m_byte_capacity, "Could not update GPU buffer, range exceeds its capacity");
+
+			if (byte_size == 0)
+				return;
+
+			AE_GL_LOG(glBindBuffer(m_target, m_buffer_id));
+			AE_GL_LOG(glBufferSubData(m_target, byte_offset, byte_size, data));
+
+			VertexArrayGPUHandler::s_upload_stats.uploaded_bytes += byte_size;
+			VertexArrayGPUHandler::s_upload_stats.upload_count++;
+		}
+	}
+}
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Graphics/Rendering/DirtyRanges.hpp"
+
+namespace ae {
+	namespace internal {
+
+		void DirtyRanges::Add(size_t first, size_t last) {
+			if (m_all || first >= last)
+				return;
+
+			// first range that ends at or after the new one begins, it may overlap or touch it
+			auto begin = std::lower_bound(m_ranges.begin(), m_ranges.end(), first,
+				[](const std::pair<size_t, size_t>& range, size_t value) {
+					return range.second < value;
+				}
+			);
+
+			// merge all ranges overlapping or touching [first, last)
+			auto end = begin;
+			while (end != m_ranges.end() && end->first <= last) {
+				first = std::min(first, end->first);
+				last = std::max(last, end->second);
+				end++;
+			}
+
+			begin = m_ranges.erase(begin, end);
+			m_ranges.insert(begin, { first, last });
+
+			// too many ranges, merge the two separated by the smallest gap
+			if (m_ranges.size() > c_max_ranges) {
+				size_t merged = 0;
+
+				for (size_t i = 1; i + 1 < m_ranges.size(); i++)
+					if (m_ranges[i + 1].first - m_ranges[i].second < m_ranges[merged + 1].first - m_ranges[merged].second)
+						merged = i;
+
+				m_ranges[merged].second = m_ranges[merged + 1].second;
+				m_ranges.erase(m_ranges.begin() + merged + 1);
+			}
+		}
+		void DirtyRanges::Add(const DirtyRanges& other) {
+			if (other.m_all) {
+				AddAll();
+				return;
+			}
+
+			for (const auto& range : other.m_ranges)
+				Add(range.first, range.second);
+		}
+		void DirtyRanges::AddAll() {
+			m_all = true;
+			m_ranges.clear();
+		}
+		void DirtyRanges::Clear() {
+			m_all = false;
+			m_ranges.clear();
+		}
+
+		bool DirtyRanges::IsEmpty() const {
+			return !m_all && m_ranges.empty();
+		}
+	}
+}
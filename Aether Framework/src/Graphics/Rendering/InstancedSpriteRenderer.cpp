@@ -39,10 +39,10 @@ namespace ae {
 	InstancedSpriteRenderer::InstancedSpriteRenderer() {
 		m_vertices.Append(
 			{
-				VertexPosTex(Vector2f(), Vector2f()),
-				VertexPosTex(Vector2f(), Vector2f()),
-				VertexPosTex(Vector2f(), Vector2f()),
-				VertexPosTex(Vector2f(), Vector2f())
+				VertexPosTex(Vector2f(), Vector2f(0.f, 0.f)),
+				VertexPosTex(Vector2f(), Vector2f(1.f, 0.f)),
+				VertexPosTex(Vector2f(), Vector2f(1.f, 1.f)),
+				VertexPosTex(Vector2f(), Vector2f(0.f, 1.f))
 			},
 			{
 				0, 1, 2, 2, 3, 0
@@ -52,6 +52,8 @@ namespace ae {
 		m_vertices.Bind();
 		m_vertices.AddLayout<Vector2f>(0, offsetof(VertexPosTex, position), false);
 		m_vertices.AddLayout<Vector2f>(1, offsetof(VertexPosTex, texcoords), false);
+
+		AddInstanceAttributes();
 	}
 	InstancedSpriteRenderer::InstancedSpriteRenderer(const InstancedSpriteRenderer& copy) {
 		*this = copy;
@@ -61,6 +63,8 @@ namespace ae {
 	}
 
 	InstancedSpriteRenderer& InstancedSpriteRenderer::operator=(const InstancedSpriteRenderer& copy) {
+		if (this == &copy)
+			return *this;
 
 		// copy renderer data
 		m_vertices = copy.m_vertices;
@@ -68,11 +72,16 @@ namespace ae {
 		m_texture = copy.m_texture;
 		m_texture_rect = copy.m_texture_rect;
 
-		// copy uniform data
+		AddInstanceAttributes();
+
+		// copy instance data, it is uploaded to own buffers on next draw
 		m_transforms = copy.m_transforms;
 		m_colors = copy.m_colors;
+		m_texture_rects = copy.m_texture_rects;
+		MarkDirty(0, copy.GetCount());
 
-		// copy instances' data
+		// copy instances' data, previous handles are dropped
+		m_instances.clear();
 		m_instances.reserve(copy.m_instances.size());
 
 		for (auto& instance_uptr : copy.m_instances) {
@@ -93,9 +102,18 @@ namespace ae {
 		m_texture = std::move(move.m_texture);
 		m_texture_rect = std::move(move.m_texture_rect);
 
-		// move uniform data
+		// move instance data with its buffers, vertex array's attributes already point to them
 		m_transforms = std::move(move.m_transforms);
 		m_colors = std::move(move.m_colors);
+		m_texture_rects = std::move(move.m_texture_rects);
+
+		m_transform_buffer = std::move(move.m_transform_buffer);
+		m_color_buffer = std::move(move.m_color_buffer);
+		m_texture_rect_buffer = std::move(move.m_texture_rect_buffer);
+
+		m_dirty_transforms = move.m_dirty_transforms;
+		m_dirty_colors = move.m_dirty_colors;
+		m_dirty_texture_rects = move.m_dirty_texture_rects;
 
 		// move instances' data
 		m_instances = std::move(move.m_instances);
@@ -121,19 +139,13 @@ namespace ae {
 
 		shader.SetUniform.Sampler2D("u_texture", 0);
 
-		m_vertices.Bind();
-		size_t max_draws_per_call = DefaultAssets->instanced_sprite_max_draws_per_call;
-
-		for (size_t drawn_instances(0); drawn_instances < GetCount(); drawn_instances += max_draws_per_call) {
-			size_t next_draw_count = std::min(max_draws_per_call, GetCount() - drawn_instances);
-
-			shader.SetUniform.Mat3x3("u_models", m_transforms.at(drawn_instances).GetArray(), 0, next_draw_count);
+		if (GetCount() == 0)
+			return;
 
-			const Vector4f* colors_data = &m_colors.at(drawn_instances);
-			shader.SetUniform.Vec4fArray("u_colors", colors_data, 0, next_draw_count);
+		m_vertices.Bind();
+		UpdateInstanceBuffers();
 
-			m_vertices.DrawInstanced(next_draw_count);
-		}
+		m_vertices.DrawInstanced(GetCount());
 	}
 	void InstancedSpriteRenderer::Draw(const std::function<void(const Texture*, size_t instance_count, const std::vector<Matrix3x3>&, const std::vector<Vector4f>&, const VertexArray<VertexPosTex>&)>& draw) const {
 		draw(m_texture, GetCount(), m_transforms, m_colors, m_vertices);
@@ -141,44 +153,85 @@ namespace ae {
 
 	void InstancedSpriteRenderer::Sort(const std::function<bool(const InstancedSprite& left, const InstancedSprite& right)>& compare) {
 
-		// insertion sort instances
-		for (int marker = 1; marker < m_instances.size(); marker++) {
+		// insertion sort instances' order
+		std::vector<std::uint32_t> order(GetCount());
+		std::iota(order.begin(), order.end(), 0);
+
+		for (size_t marker = 1; marker < order.size(); marker++) {
 
-			std::unique_ptr<InstancedSprite> instance = std::move(m_instances[marker]);
-			int sub_marker = marker - 1;
+			std::uint32_t index = order[marker];
+			std::ptrdiff_t sub_marker = static_cast<std::ptrdiff_t>(marker) - 1;
 
-			while (sub_marker >= 0 && compare(*m_instances[sub_marker], *instance)) {
-				m_instances[sub_marker + 1] = std::move(m_instances[sub_marker]);
+			while (sub_marker >= 0 && compare(*m_instances[order[sub_marker]], *m_instances[index])) {
+				order[sub_marker + 1] = order[sub_marker];
 
 				sub_marker--;
 			}
-			m_instances[sub_marker + 1] = std::move(instance);
+			order[sub_marker + 1] = index;
 		}
 
-		// create new order and update instances' m_index
-		std::vector<size_t> new_order;
-		new_order.reserve(GetCount());
-		for (size_t i(0); i < GetCount(); i++) {
-			InstancedSprite& instance = *m_instances.at(i);
+		Reorder(order);
+	}
+	void InstancedSpriteRenderer::Reorder(const std::vector<std::uint32_t>& order) {
 
-			new_order.push_back(instance.m_index);
-			instance.m_index = i;
-		}
+		// check if anything has moved
+		size_t first_moved = 0;
+		while (first_moved < order.size() && order[first_moved] == first_moved)
+			first_moved++;
+
+		if (first_moved == order.size())
+			return;
 
-		// safely reorder uniforms by new order
-		for (size_t i = 0; i < GetCount() - 1; i++) {
-			if (new_order[i] == i)
-				continue;
+		// move instances and their data in linear time and update instances' m_index
+		internal::ApplySortOrder(m_instances.data(), order);
+		internal::ApplySortOrder(m_transforms.data(), order);
+		internal::ApplySortOrder(m_colors.data(), order);
+		internal::ApplySortOrder(m_texture_rects.data(), order);
 
-			size_t o;
-			for (o = i + 1; o < new_order.size(); ++o)
-				if (new_order[o] == i)
-					break;
+		for (size_t i = first_moved; i < GetCount(); i++)
+			m_instances[i]->m_index = i;
 
-			std::swap(m_transforms[i], m_transforms[new_order[i]]);
-			std::swap(m_colors[i], m_colors[new_order[i]]);
-			std::swap(new_order[i], new_order[o]);
-		}
+		MarkDirty(first_moved, GetCount());
+	}
+
+	void InstancedSpriteRenderer::AddInstanceAttributes() {
+		m_vertices.Bind();
+
+		// mat3 attribute takes three locations, one for each column
+		for (std::uint32_t column = 0; column < 3; column++)
+			m_transform_buffer.AddInstanceAttribute(2 + column, internal::VertexAttributeTypeInfo::Create(Vector3f()), false, sizeof(Matrix3x3), column * 3 * sizeof(float));
+
+		m_color_buffer.AddInstanceAttribute(5, internal::VertexAttributeTypeInfo::Create(Vector4f()), false, sizeof(Vector4f), 0);
+
+		static_assert(sizeof(IntRect) == sizeof(Vector4i), "IntRect has to be tightly packed to be used as a vertex attribute");
+		m_texture_rect_buffer.AddInstanceAttribute(6, internal::VertexAttributeTypeInfo::Create(Vector4i()), false, sizeof(IntRect), 0);
+
+		// restore vertex array's own buffer
+		m_vertices.Bind();
+	}
+	void InstancedSpriteRenderer::MarkDirty(size_t first_index, size_t last_index) {
+		m_dirty_transforms.Add(first_index, last_index);
+		m_dirty_colors.Add(first_index, last_index);
+		m_dirty_texture_rects.Add(first_index, last_index);
+	}
+	void InstancedSpriteRenderer::UpdateInstanceBuffers() const {
+		auto upload = [](internal::BufferGPUHandler& buffer, const auto& data, internal::DirtyRanges& dirty) {
+			constexpr size_t element_size = sizeof(typename std::decay_t<decltype(data)>::value_type);
+
+			// reallocated buffer loses its content
+			if (buffer.Reserve(element_size * data.size()))
+				dirty.AddAll();
+
+			dirty.ForEach(data.size(), [&](size_t first, size_t last) {
+				buffer.UpdateRange(element_size * first, element_size * (last - first), data.data() + first);
+			});
+
+			dirty.Clear();
+		};
+
+		upload(m_transform_buffer, m_transforms, m_dirty_transforms);
+		upload(m_color_buffer, m_colors, m_dirty_colors);
+		upload(m_texture_rect_buffer, m_texture_rects, m_dirty_texture_rects);
 	}
 
 	void InstancedSpriteRenderer::SetTexture(const Texture& texture) {
@@ -207,23 +260,21 @@ namespace ae {
 	}
 	void InstancedSpriteRenderer::SetTextureRect(const IntRect& rect) {
 		m_texture_rect = rect;
-		UpdateTextureCoords();
-	}
-	void InstancedSpriteRenderer::UpdateTextureCoords() {
-		std::vector<VertexPosTex> new_vertices = m_vertices.GetVertices();
-
-		new_vertices[0].texcoords = Vector2f(m_texture_rect.left, m_texture_rect.top);
-		new_vertices[1].texcoords = Vector2f(m_texture_rect.left + m_texture_rect.width, m_texture_rect.top);
-		new_vertices[2].texcoords = Vector2f(m_texture_rect.left + m_texture_rect.width, m_texture_rect.top + m_texture_rect.height);
-		new_vertices[3].texcoords = Vector2f(m_texture_rect.left, m_texture_rect.top + m_texture_rect.height);
 
-		m_vertices.SetVertices(new_vertices);
+		std::fill(m_texture_rects.begin(), m_texture_rects.end(), rect);
+		m_dirty_texture_rects.Add(0, GetCount());
 	}
 	size_t InstancedSpriteRenderer::GetCount() const {
 		return m_instances.size();
 	}
 
 	InstancedSprite& InstancedSpriteRenderer::CreateBack(const Matrix3x3& transform, const Color& color) {
+		return CreateBack(transform, color, m_texture_rect);
+	}
+	InstancedSprite& InstancedSpriteRenderer::Create(size_t index, const Matrix3x3& transform, const Color& color) {
+		return Create(index, transform, color, m_texture_rect);
+	}
+	InstancedSprite& InstancedSpriteRenderer::CreateBack(const Matrix3x3& transform, const Color& color, const IntRect& texture_rect) {
 		InstancedSprite* instance = m_instances.emplace(m_instances.end(), new InstancedSprite())->get();
 
 		instance->m_renderer = this;
@@ -231,10 +282,13 @@ namespace ae {
 
 		m_transforms.emplace(m_transforms.end(), transform);
 		m_colors.emplace(m_colors.end(), color.GetNormalized());
+		m_texture_rects.emplace(m_texture_rects.end(), texture_rect);
+
+		MarkDirty(GetCount() - 1, GetCount());
 
 		return *instance;
 	}
-	InstancedSprite& InstancedSpriteRenderer::Create(size_t index, const Matrix3x3& transform, const Color& color) {
+	InstancedSprite& InstancedSpriteRenderer::Create(size_t index, const Matrix3x3& transform, const Color& color, const IntRect& texture_rect) {
 		InstancedSprite* instance = m_instances.emplace(m_instances.begin() + index, new InstancedSprite())->get();
 
 		instance->m_renderer = this;
@@ -242,21 +296,27 @@ namespace ae {
 
 		m_transforms.emplace(m_transforms.begin() + index, transform);
 		m_colors.emplace(m_colors.begin() + index, color.GetNormalized());
+		m_texture_rects.emplace(m_texture_rects.begin() + index, texture_rect);
 
 		// update other instances' positions
 		for (size_t i(index + 1); i < GetCount(); i++)
 			m_instances.at(i)->m_index++;
 
+		MarkDirty(index, GetCount());
+
 		return *instance;
 	}
 	void InstancedSpriteRenderer::Destroy(size_t index) {
 		m_transforms.erase(m_transforms.begin() + index);
 		m_colors.erase(m_colors.begin() + index);
+		m_texture_rects.erase(m_texture_rects.begin() + index);
 		m_instances.erase(m_instances.begin() + index);
 
 		// update other instances' positions
 		for (size_t i(index); i < GetCount(); i++)
 			m_instances.at(i)->m_index--;
+
+		MarkDirty(index, GetCount());
 	}
 	void InstancedSpriteRenderer::Destroy(InstancedSprite* instance) {
 		Destroy(instance->m_index);
@@ -265,6 +325,7 @@ namespace ae {
 		m_instances.clear();
 		m_transforms.clear();
 		m_colors.clear();
+		m_texture_rects.clear();
 	}
 	InstancedSprite& InstancedSpriteRenderer::Get(size_t index) const {
 		return *m_instances.at(index);
@@ -276,6 +337,7 @@ namespace ae {
 
 	void InstancedSprite::SetTransform(const Matrix3x3& transform) {
 		m_renderer->m_transforms.at(m_index) = transform;
+		m_renderer->m_dirty_transforms.Add(m_index, m_index + 1);
 	}
 	const Matrix3x3& InstancedSprite::GetTransform() const {
 		return m_renderer->m_transforms.at(m_index);
@@ -283,11 +345,20 @@ namespace ae {
 
 	void InstancedSprite::SetColor(const Color& color) {
 		m_renderer->m_colors.at(m_index) = color.GetNormalized();
+		m_renderer->m_dirty_colors.Add(m_index, m_index + 1);
 	}
 	Color InstancedSprite::GetColor() const {
 		return Color(m_renderer->m_colors.at(m_index));
 	}
 
+	void InstancedSprite::SetTextureRect(const IntRect& rect) {
+		m_renderer->m_texture_rects.at(m_index) = rect;
+		m_renderer->m_dirty_texture_rects.Add(m_index, m_index + 1);
+	}
+	const IntRect& InstancedSprite::GetTextureRect() const {
+		return m_renderer->m_texture_rects.at(m_index);
+	}
+
 	InstancedSpriteRenderer& InstancedSprite::GetRenderer() const { return *m_renderer; }
 	size_t InstancedSprite::GetIndex() const { return m_index; }
 }
\ No newline at end of file
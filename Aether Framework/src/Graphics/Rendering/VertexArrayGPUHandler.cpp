@@ -35,10 +35,14 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace ae {
 	namespace internal {
 
 		AE_DEBUG_ONLY(std::uint32_t VertexArrayGPUHandler::s_bound_vao_id = 0);
+		GPUUploadStats VertexArrayGPUHandler::s_upload_stats;
 
 		VertexArrayGPUHandler::VertexArrayGPUHandler() {
 			AllocateBuffers();
@@ -66,6 +70,30 @@ namespace ae {
 		}
 
 		void VertexArrayGPUHandler::CopyFrom(const VertexArrayGPUHandler& copy){
+			SetMode(copy.m_mode);
+
+			// Streaming buffers are not copied, vertex array uploads its data again
+			if (m_mode == VertexBufferMode::Dynamic) {
+				CopyBuffers(copy);
+			}
+
+			// Bind buffers to VAO
+			Bind();
+
+			// Copy attributes
+			if (!m_attributes.empty()) {
+
+				for (const VertexAttribute& attribute : m_attributes) {
+					AE_GL_LOG(glDisableVertexAttribArray(attribute.location));
+				}
+
+				m_attributes.clear();
+			}
+				
+			for (const VertexAttribute& attribute : copy.m_attributes)
+				AddAttribute(attribute.location, attribute.ati, attribute.normalize, attribute.byte_size, attribute.byte_offset);
+		}
+		void VertexArrayGPUHandler::CopyBuffers(const VertexArrayGPUHandler& copy) {
 			GLint size;
 
 			// Copy VBO
@@ -76,6 +104,7 @@ namespace ae {
 			AE_GL_LOG(glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_DYNAMIC_DRAW));
 
 			AE_GL_LOG(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size));
+			m_vbo_byte_capacity = static_cast<size_t>(size);
 
 			// Copy EBO
 			AE_GL_LOG(glBindBuffer(GL_COPY_READ_BUFFER, copy.m_ebo_id));
@@ -85,22 +114,7 @@ namespace ae {
 			AE_GL_LOG(glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_DYNAMIC_DRAW));
 
 			AE_GL_LOG(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size));
-
-			// Bind buffers to VAO
-			Bind();
-
-			// Copy attributes
-			if (!m_attributes.empty()) {
-
-				for (const VertexAttribute& attribute : m_attributes) {
-					AE_GL_LOG(glDisableVertexAttribArray(attribute.location));
-				}
-
-				m_attributes.clear();
-			}
-				
-			for (const VertexAttribute& attribute : copy.m_attributes)
-				AddAttribute(attribute.location, attribute.ati, attribute.normalize, attribute.byte_size, attribute.byte_offset);
+			m_ebo_byte_capacity = static_cast<size_t>(size);
 		}
 		void VertexArrayGPUHandler::MoveFrom(VertexArrayGPUHandler&& move) noexcept {
 
@@ -110,9 +124,37 @@ namespace ae {
 			m_vbo_id = move.m_vbo_id;
 			m_ebo_id = move.m_ebo_id;
 
+			m_vbo_byte_capacity = move.m_vbo_byte_capacity;
+			m_ebo_byte_capacity = move.m_ebo_byte_capacity;
+
 			move.m_vao_id = 0;
 			move.m_vbo_id = 0;
 			move.m_ebo_id = 0;
+
+			move.m_vbo_byte_capacity = 0;
+			move.m_ebo_byte_capacity = 0;
+
+			// streaming
+			m_mode = move.m_mode;
+			m_region = move.m_region;
+			m_stream_vertex_capacity = move.m_stream_vertex_capacity;
+			m_stream_index_capacity = move.m_stream_index_capacity;
+			m_vbo_map = move.m_vbo_map;
+			m_ebo_map = move.m_ebo_map;
+
+			for (size_t region = 0; region < c_stream_region_count; region++) {
+				m_fences[region] = move.m_fences[region];
+				m_region_dirty_vertices[region] = std::move(move.m_region_dirty_vertices[region]);
+				m_region_dirty_indices[region] = std::move(move.m_region_dirty_indices[region]);
+
+				move.m_fences[region] = nullptr;
+			}
+
+			move.m_mode = VertexBufferMode::Dynamic;
+			move.m_vbo_map = nullptr;
+			move.m_ebo_map = nullptr;
+			move.m_stream_vertex_capacity = 0;
+			move.m_stream_index_capacity = 0;
 		}
 
 		void VertexArrayGPUHandler::AllocateBuffers() {
@@ -121,6 +163,8 @@ namespace ae {
 			AE_GL_LOG(glGenBuffers(1, &m_ebo_id));
 		}
 		void VertexArrayGPUHandler::DeallocateBuffers() {
+			ReleaseStreaming();
+
 			GLuint buffers[2] = { m_vbo_id, m_ebo_id };
 			AE_GL_LOG(glDeleteBuffers(2, buffers));
 			AE_GL_LOG(glDeleteVertexArrays(1, &m_vao_id));
@@ -140,7 +184,10 @@ namespace ae {
 			
 			m_attributes.emplace_back(location, ati, normalize, byte_size, byte_offset);
 
-			AE_GL_LOG(glVertexAttribPointer(location, ati.component_count, ati.gl_type, normalize, byte_size, reinterpret_cast<void*>(byte_offset)));
+			// streaming attributes point to the region written last
+			size_t region_byte_offset = (m_mode == VertexBufferMode::Streaming) ? m_region * m_stream_vertex_capacity * byte_size : 0;
+
+			AE_GL_LOG(glVertexAttribPointer(location, ati.component_count, ati.gl_type, normalize, byte_size, reinterpret_cast<void*>(region_byte_offset + byte_offset)));
 			AE_GL_LOG(glEnableVertexAttribArray(location));
 		}
 
@@ -159,36 +206,253 @@ namespace ae {
 			AE_GL_LOG(glBindBuffer(GL_ARRAY_BUFFER, 0));
 		}
 		void VertexArrayGPUHandler::Draw(std::int32_t draw_mode, size_t start_index_index, size_t indices_count) const {
+			start_index_index += GetIndexOffset();
 			AE_GL_LOG(glDrawElements(draw_mode, indices_count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(start_index_index * sizeof(std::uint32_t))));
+			FenceRegion();
 		}
 		void VertexArrayGPUHandler::DrawInstanced(std::int32_t draw_mode, size_t start_index_index, size_t indices_count, size_t instance_count) const {
+			start_index_index += GetIndexOffset();
 			AE_GL_LOG(glDrawElementsInstanced(draw_mode, indices_count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(start_index_index * sizeof(std::uint32_t)), instance_count));
+			FenceRegion();
 		}
 
-		void VertexArrayGPUHandler::UpdateReallocate(size_t vertices_byte_size, const void* vertices_data, size_t indices_byte_size, const void* indices_data) const {
+		void VertexArrayGPUHandler::SetMode(VertexBufferMode mode) {
+			if (mode == VertexBufferMode::Streaming && !GLAD_GL_VERSION_4_4) {
+				AE_WARNING("[Aether] Streaming vertex buffers require OpenGL 4.4, dynamic buffers are used instead");
+				mode = VertexBufferMode::Dynamic;
+			}
+
+			if (mode == m_mode)
+				return;
 
-			// Ensure empty buffers = NULL
-			const void* new_vertex_data = (vertices_byte_size != 0) ? vertices_data : NULL;
-			const void* new_indices_data = (indices_byte_size != 0) ? indices_data  : NULL;
+			// storage of streaming buffers is immutable, new buffers are needed in both directions
+			ReleaseStreaming();
 
-			// Vertices
-			AE_GL_LOG(glBindBuffer(GL_ARRAY_BUFFER, m_vbo_id));
-			AE_GL_LOG(glBufferData(GL_ARRAY_BUFFER, vertices_byte_size, new_vertex_data, GL_DYNAMIC_DRAW));
+			GLuint buffers[2] = { m_vbo_id, m_ebo_id };
+			AE_GL_LOG(glDeleteBuffers(2, buffers));
+			AE_GL_LOG(glGenBuffers(1, &m_vbo_id));
+			AE_GL_LOG(glGenBuffers(1, &m_ebo_id));
 
-			// Indices
-			AE_GL_LOG(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo_id));
-			AE_GL_LOG(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_byte_size, new_indices_data, GL_DYNAMIC_DRAW));
+			m_vbo_byte_capacity = 0;
+			m_ebo_byte_capacity = 0;
+			m_mode = mode;
 
+			BindAttributes(0);
+		}
+		VertexBufferMode VertexArrayGPUHandler::GetMode() const {
+			return m_mode;
 		}
-		void VertexArrayGPUHandler::Update(size_t vertices_byte_size, const void* vertices_data, size_t indices_byte_size, const void* indices_data) const {
 
-			// Vertices
-			AE_GL_LOG(glBindBuffer(GL_ARRAY_BUFFER, m_vbo_id));
-			AE_GL_LOG(glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_byte_size, vertices_data));
+		void VertexArrayGPUHandler::Update(
+			const void* vertices, size_t vertex_byte_size, size_t vertex_count, DirtyRanges& dirty_vertices,
+			const void* indices, size_t index_count, DirtyRanges& dirty_indices
+		) {
+			if (m_mode == VertexBufferMode::Streaming) {
+				UpdateStreaming(vertices, vertex_byte_size, vertex_count, dirty_vertices, indices, index_count, dirty_indices);
+			}
+			else {
+				constexpr size_t index_byte_size = sizeof(std::uint32_t);
 
-			// Indices
-			AE_GL_LOG(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo_id));
-			AE_GL_LOG(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices_byte_size, indices_data));
+				// Vertices, reallocation requires uploading everything
+				if (Reserve(GL_ARRAY_BUFFER, m_vbo_id, m_vbo_byte_capacity, vertex_byte_size * vertex_count))
+					dirty_vertices.AddAll();
+
+				dirty_vertices.ForEach(vertex_count, [&](size_t first, size_t last) {
+					UpdateRange(GL_ARRAY_BUFFER, m_vbo_id, vertex_byte_size * first, vertex_byte_size * (last - first), static_cast<const char*>(vertices) + vertex_byte_size * first);
+				});
+
+				// Indices
+				if (Reserve(GL_ELEMENT_ARRAY_BUFFER, m_ebo_id, m_ebo_byte_capacity, index_byte_size * index_count))
+					dirty_indices.AddAll();
+
+				dirty_indices.ForEach(index_count, [&](size_t first, size_t last) {
+					UpdateRange(GL_ELEMENT_ARRAY_BUFFER, m_ebo_id, index_byte_size * first, index_byte_size * (last - first), static_cast<const char*>(indices) + index_byte_size * first);
+				});
+			}
+
+			dirty_vertices.Clear();
+			dirty_indices.Clear();
+		}
+
+		bool VertexArrayGPUHandler::Reserve(std::uint32_t gl_target, std::uint32_t buffer_id, size_t& byte_capacity, size_t byte_size) {
+			if (byte_size <= byte_capacity)
+				return false;
+
+			byte_capacity = std::max(byte_size, byte_capacity * 2);
+
+			AE_GL_LOG(glBindBuffer(gl_target, buffer_id));
+			AE_GL_LOG(glBufferData(gl_target, byte_capacity, NULL, GL_DYNAMIC_DRAW));
+
+			s_upload_stats.reallocation_count++;
+			return true;
+		}
+		void VertexArrayGPUHandler::UpdateRange(std::uint32_t gl_target, std::uint32_t buffer_id, size_t byte_offset, size_t byte_size, const void* data) {
+			if (byte_size == 0)
+				return;
+
+			AE_GL_LOG(glBindBuffer(gl_target, buffer_id));
+			AE_GL_LOG(glBufferSubData(gl_target, byte_offset, byte_size, data));
+
+			s_upload_stats.uploaded_bytes += byte_size;
+			s_upload_stats.upload_count++;
+		}
+
+		void VertexArrayGPUHandler::UpdateStreaming(
+			const void* vertices, size_t vertex_byte_size, size_t vertex_count, const DirtyRanges& dirty_vertices,
+			const void* indices, size_t index_count, const DirtyRanges& dirty_indices
+		) {
+			constexpr size_t index_byte_size = sizeof(std::uint32_t);
+
+			// every region has to receive the changes before it is drawn again
+			for (size_t region = 0; region < c_stream_region_count; region++) {
+				m_region_dirty_vertices[region].Add(dirty_vertices);
+				m_region_dirty_indices[region].Add(dirty_indices);
+			}
+
+			ReserveStreaming(vertex_byte_size, vertex_count, index_count);
+
+			if (dirty_vertices.IsEmpty() && dirty_indices.IsEmpty() && m_region_dirty_vertices[m_region].IsEmpty() && m_region_dirty_indices[m_region].IsEmpty())
+				return;
+
+			// write the least recently written region, once GPU stopped reading it
+			m_region = (m_region + 1) % c_stream_region_count;
+			WaitForRegion(m_region);
+
+			if (m_vbo_map) {
+				char* region_vertices = static_cast<char*>(m_vbo_map) + m_region * m_stream_vertex_capacity * vertex_byte_size;
+
+				m_region_dirty_vertices[m_region].ForEach(vertex_count, [&](size_t first, size_t last) {
+					std::memcpy(region_vertices + vertex_byte_size * first, static_cast<const char*>(vertices) + vertex_byte_size * first, vertex_byte_size * (last - first));
+
+					s_upload_stats.uploaded_bytes += vertex_byte_size * (last - first);
+					s_upload_stats.upload_count++;
+				});
+			}
+
+			if (m_ebo_map) {
+				char* region_indices = static_cast<char*>(m_ebo_map) + m_region * m_stream_index_capacity * index_byte_size;
+
+				m_region_dirty_indices[m_region].ForEach(index_count, [&](size_t first, size_t last) {
+					std::memcpy(region_indices + index_byte_size * first, static_cast<const char*>(indices) + index_byte_size * first, index_byte_size * (last - first));
+
+					s_upload_stats.uploaded_bytes += index_byte_size * (last - first);
+					s_upload_stats.upload_count++;
+				});
+			}
+
+			m_region_dirty_vertices[m_region].Clear();
+			m_region_dirty_indices[m_region].Clear();
+
+			// attributes read the region written now
+			BindAttributes(m_region * m_stream_vertex_capacity * vertex_byte_size);
+		}
+		void VertexArrayGPUHandler::ReserveStreaming(size_t vertex_byte_size, size_t vertex_count, size_t index_count) {
+			bool reallocate_vertices = (vertex_count > m_stream_vertex_capacity);
+			bool reallocate_indices = (index_count > m_stream_index_capacity);
+
+			if (!reallocate_vertices && !reallocate_indices)
+				return;
+
+			// fences guard old buffers only, deleted buffers are released by the driver once GPU stops using them
+			for (size_t region = 0; region < c_stream_region_count; region++) {
+				if (m_fences[region]) {
+					AE_GL_LOG(glDeleteSync(static_cast<GLsync>(m_fences[region])));
+					m_fences[region] = nullptr;
+				}
+			}
+
+			if (reallocate_vertices) {
+				m_stream_vertex_capacity = std::max(vertex_count, m_stream_vertex_capacity * 2);
+				m_vbo_map = AllocateStreamingBuffer(GL_ARRAY_BUFFER, m_vbo_id, m_stream_vertex_capacity * vertex_byte_size * c_stream_region_count);
+				m_vbo_byte_capacity = m_stream_vertex_capacity * vertex_byte_size * c_stream_region_count;
+
+				for (DirtyRanges& dirty : m_region_dirty_vertices)
+					dirty.AddAll();
+			}
+
+			if (reallocate_indices) {
+				m_stream_index_capacity = std::max(index_count, m_stream_index_capacity * 2);
+				m_ebo_map = AllocateStreamingBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo_id, m_stream_index_capacity * sizeof(std::uint32_t) * c_stream_region_count);
+				m_ebo_byte_capacity = m_stream_index_capacity * sizeof(std::uint32_t) * c_stream_region_count;
+
+				for (DirtyRanges& dirty : m_region_dirty_indices)
+					dirty.AddAll();
+			}
+
+			// attach new buffers to the vertex array
+			BindAttributes(m_region * m_stream_vertex_capacity * vertex_byte_size);
+		}
+		void* VertexArrayGPUHandler::AllocateStreamingBuffer(std::uint32_t gl_target, std::uint32_t& buffer_id, size_t byte_size) {
+			constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+			AE_GL_LOG(glDeleteBuffers(1, &buffer_id));
+			AE_GL_LOG(glGenBuffers(1, &buffer_id));
+
+			AE_GL_LOG(glBindBuffer(gl_target, buffer_id));
+			AE_GL_LOG(glBufferStorage(gl_target, byte_size, NULL, flags));
+
+			s_upload_stats.reallocation_count++;
+
+			void* map;
+			AE_GL_LOG(map = glMapBufferRange(gl_target, 0, byte_size, flags));
+			return map;
+		}
+		void VertexArrayGPUHandler::ReleaseStreaming() {
+			for (size_t region = 0; region < c_stream_region_count; region++) {
+				if (m_fences[region]) {
+					AE_GL_LOG(glDeleteSync(static_cast<GLsync>(m_fences[region])));
+					m_fences[region] = nullptr;
+				}
+
+				m_region_dirty_vertices[region].Clear();
+				m_region_dirty_indices[region].Clear();
+			}
+
+			// deleting buffers unmaps them
+			m_vbo_map = nullptr;
+			m_ebo_map = nullptr;
+			m_stream_vertex_capacity = 0;
+			m_stream_index_capacity = 0;
+			m_region = 0;
+		}
+
+		void VertexArrayGPUHandler::WaitForRegion(size_t region) const {
+			if (!m_fences[region])
+				return;
+
+			GLsync fence = static_cast<GLsync>(m_fences[region]);
+			GLenum result;
+
+			do {
+				AE_GL_LOG(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+			} while (result == GL_TIMEOUT_EXPIRED);
+
+			AE_GL_LOG(glDeleteSync(fence));
+			m_fences[region] = nullptr;
+		}
+		void VertexArrayGPUHandler::FenceRegion() const {
+			if (m_mode != VertexBufferMode::Streaming)
+				return;
+
+			// only the latest draw reading the region matters
+			if (m_fences[m_region]) {
+				AE_GL_LOG(glDeleteSync(static_cast<GLsync>(m_fences[m_region])));
+			}
+
+			GLsync fence;
+			AE_GL_LOG(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+			m_fences[m_region] = fence;
+		}
+		size_t VertexArrayGPUHandler::GetIndexOffset() const {
+			return (m_mode == VertexBufferMode::Streaming) ? m_region * m_stream_index_capacity : 0;
+		}
+
+		void VertexArrayGPUHandler::BindAttributes(size_t byte_offset) const {
+			Bind();
+
+			for (const VertexAttribute& attribute : m_attributes) {
+				AE_GL_LOG(glVertexAttribPointer(attribute.location, attribute.ati.component_count, attribute.ati.gl_type, attribute.normalize, attribute.byte_size, reinterpret_cast<void*>(byte_offset + attribute.byte_offset)));
+			}
 		}
 	}
 }
\ No newline at end of file
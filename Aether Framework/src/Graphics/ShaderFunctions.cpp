@@ -128,6 +128,14 @@ namespace ae {
 				AE_GL_LOG(glGetIntegerv(GL_MAX_COMPUTE_UNIFORM_COMPONENTS, &value));
 				return static_cast<size_t>(value);
 			}
+			size_t RetrieveInformationFunctions::MaxShaderStorageBlocksVertex() {
+				if (!GLAD_GL_VERSION_4_3)
+					return 0;
+
+				GLint value;
+				AE_GL_LOG(glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &value));
+				return static_cast<size_t>(value);
+			}
 
 			// Uniforms //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 			SetUniformFunctions::SetUniformFunctions(ae::Shader* shader) : m_shader(shader) {}
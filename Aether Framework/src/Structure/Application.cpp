@@ -42,12 +42,15 @@
 #include "System/LogError.hpp"
 
 #include "Structure/Application.hpp"
+#include "Graphics/Rendering/VertexArrayGPUHandler.hpp"
 #include "Structure/SceneManager.hpp"
 #include "Structure/AssetManager.hpp"
 #include "Structure/Camera.hpp"
 #include "Structure/LayerManager.hpp"
 #include "Structure/Cursor.hpp"
+#include "Structure/JobPool.hpp"
 #include "Structure/EntityComponentSystem/EntityManager.hpp"
+#include "Structure/EntityComponentSystem/SystemScheduler.hpp"
 
 #include "Graphics/Font.hpp"
 #include "Audio/AudioDevice.hpp"
@@ -73,6 +76,9 @@ namespace ae {
         Time ApplicationType::GetRunTime() const {
             return Time(glfwGetTime()) - m_start_time;
         }
+        const GPUUploadStats& ApplicationType::GetUploadStats() const {
+            return m_upload_stats;
+        }
 
         void ApplicationType::Initialize(const Vector2i& window_size, const std::string& window_title, const ContextSettings& context_settings, const FrameworkSettings& framework_settings) {
 
@@ -137,12 +143,14 @@ namespace ae {
 
         void ApplicationType::Terminate() {
             SceneManager.Terminate();
+            SystemScheduler.RemoveAllSystems();
             AssetManager.Terminate();
             internal::TerminateFontLibrary();
             Cursor.Terminate();
             Window.Terminate();
             glfwTerminate();
             AudioDevice::Terminate();
+            JobPool.Terminate();
         }
 
         void ApplicationType::Run() {
@@ -166,6 +174,7 @@ namespace ae {
 
                 // Operations
                 SceneManager.GetActiveScene()->Update();
+                SystemScheduler.Update();
 
                 // Draw if window is visible
                 if (ae::Window.GetContextSize() != Vector2i()) {
@@ -184,6 +193,10 @@ namespace ae {
                 // Get Tickrate
                 m_ticktime = tick_meter.GetElapsedTime();
                 tick_meter.Restart();
+
+                // Get GPU uploads
+                m_upload_stats = internal::VertexArrayGPUHandler::s_upload_stats;
+                internal::VertexArrayGPUHandler::s_upload_stats = GPUUploadStats();
             }
 
             if (m_close_callback)
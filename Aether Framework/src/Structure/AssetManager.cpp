@@ -475,9 +475,6 @@ namespace ae {
 			);
 
 			// instance shaders
-			constexpr size_t mat3_comp_count = 12, vec4_comp_count = 4;
-			instanced_sprite_max_draws_per_call = static_cast<size_t>((Shader::RetrieveInfo.MaxUniformComponentsVertex() - mat3_comp_count) / (mat3_comp_count + vec4_comp_count));
-
 			instanced_sprite_shader.Load(
 				Shader::LoadMode::FromSource,
 
@@ -485,19 +482,20 @@ namespace ae {
 					 \n\
 					layout(location = 0) in vec2 a_position; \n\
 					layout(location = 1) in vec2 a_texcoords; \n\
+					layout(location = 2) in mat3 a_model; \n\
+					layout(location = 5) in vec4 a_color; \n\
+					layout(location = 6) in vec4 a_texture_rect; \n\
 					 \n\
 					out vec2 v_texcoords; \n\
 					out vec4 v_color; \n\
 					 \n\
-					uniform vec4 u_colors[" + std::to_string(instanced_sprite_max_draws_per_call) + "]; \n\
-					uniform mat3 u_models[" + std::to_string(instanced_sprite_max_draws_per_call) + "]; \n\
 					uniform mat3 u_vp; \n\
 					 \n\
 					void main() \n\
 					{ \n\
-						gl_Position = vec4(u_vp * u_models[gl_InstanceID] * vec3(a_position, 1.0), 1.0); \n\
-						v_texcoords = a_texcoords; \n\
-						v_color = u_colors[gl_InstanceID]; \n\
+						gl_Position = vec4(u_vp * a_model * vec3(a_position, 1.0), 1.0); \n\
+						v_texcoords = a_texture_rect.xy + a_texcoords * a_texture_rect.zw; \n\
+						v_color = a_color; \n\
 					}",
 
 				"#version 460 core \n\
@@ -517,7 +515,7 @@ namespace ae {
 			);
 
 			// batch shaders
-			constexpr size_t uint_comp_count = 1;
+			constexpr size_t mat3_comp_count = 12, uint_comp_count = 1;
 			batch_sprite_max_draws_per_call = static_cast<size_t>((Shader::RetrieveInfo.MaxUniformComponentsVertex() - mat3_comp_count - uint_comp_count) / mat3_comp_count);
 
 			batch_sprite_shader.Load(
@@ -559,6 +557,59 @@ namespace ae {
 					}"
 			);
 
+			// batch shaders reading transforms from a shader storage buffer, drawn with a single call
+			batch_sprite_storage_supported = (Shader::RetrieveInfo.MaxShaderStorageBlocksVertex() > 0);
+
+			if (batch_sprite_storage_supported)
+				batch_sprite_storage_shader.Load(
+					Shader::LoadMode::FromSource,
+
+					"#version 460 core \n\
+						 \n\
+						layout(location = 0) in vec2 a_position; \n\
+						layout(location = 1) in vec2 a_texcoords; \n\
+						layout(location = 2) in vec4 a_color; \n\
+						 \n\
+						out vec2 v_texcoords; \n\
+						out vec4 v_color; \n\
+						 \n\
+						layout(std430, binding = 0) readonly buffer Models \n\
+						{ \n\
+							float u_models[]; \n\
+						}; \n\
+						 \n\
+						uniform mat3 u_vp; \n\
+						 \n\
+						void main() \n\
+						{ \n\
+							int i = (gl_VertexID / 4) * 9; \n\
+							mat3 model = mat3( \n\
+								u_models[i    ], u_models[i + 1], u_models[i + 2], \n\
+								u_models[i + 3], u_models[i + 4], u_models[i + 5], \n\
+								u_models[i + 6], u_models[i + 7], u_models[i + 8] \n\
+							); \n\
+							 \n\
+							gl_Position = vec4(u_vp * model * vec3(a_position, 1.0), 1.0); \n\
+							v_texcoords = a_texcoords; \n\
+							v_color = a_color; \n\
+						}",
+
+					"#version 460 core \n\
+						 \n\
+						layout(location = 0) out vec4 a_color; \n\
+						 \n\
+						in vec2 v_texcoords; \n\
+						in vec4 v_color; \n\
+						 \n\
+						uniform sampler2D u_texture; \n\
+						 \n\
+						void main() \n\
+						{ \n\
+							vec2 normalized_coords = v_texcoords / vec2(textureSize(u_texture, 0)); \n\
+							a_color = texture(u_texture, normalized_coords) * v_color; \n\
+						}"
+				);
+
 			// checkboard
 			TextureCanvas canvas;
 			canvas.Create(Vector2ui(2, 2), Color(160, 140, 140));
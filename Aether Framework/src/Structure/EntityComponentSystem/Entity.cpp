@@ -32,85 +32,111 @@
 
 
 #include "Structure/EntityComponentSystem/Entity.hpp"
+#include "Structure/EntityComponentSystem/Component.hpp"
 
-static std::vector<ae::EntityGroup> RemoveDuplications(std::vector<ae::EntityGroup> vec) {
-	for (auto it(vec.begin()); it != vec.end(); it++)
-		for (auto it2(it + 1); it2 != vec.end();)
-			if (*it == *it2) {
-				it2 = vec.erase(it2);
-			}
-			else
-				it2++;
-
-	return std::move(vec);
-}
+#include <algorithm>
 
 namespace ae {
 
 	void Entity::AddToGroup(EntityGroup group) {
 		AE_ASSERT(!IsInGroup(group), "Entity already belongs to group '" << group << '\'');
 
-		EntityManager.RegisterEntityToGroup(group, this);
-		EntityManager.UpdateViews(this, m_groups, { group }, {});
-
-		m_groups.push_back(group);
+		AttachGroup(group);
+		EntityManager.UpdateGroupViews(this, group);
 	}
 	void Entity::RemoveFromGroup(EntityGroup group) {
 		AE_ASSERT(group != AllEntitiesGroup, "Removing 'AllEntitiesGroup' (index 0) using Entity::RemoveFromGroup is forbidden");
 		AE_ASSERT(IsInGroup(group), "Entity does not belong to group '" << group << '\'');
 
-		EntityManager.UnregisterEntityFromGroup(group, this);
-		EntityManager.UpdateViews(this, m_groups, {}, { group });
-
-		m_groups.erase(std::find(m_groups.begin(), m_groups.end(), group));
+		DetachGroup(group);
+		EntityManager.UpdateGroupViews(this, group);
 	}
 
 	void Entity::AddToGroups(const std::vector<EntityGroup>& groups) {
 
-		std::vector<EntityGroup> new_groups = RemoveDuplications(groups);
+		// attached groups are skipped, including duplicates of the list
+		std::vector<EntityGroup> changed_groups;
+		changed_groups.reserve(groups.size());
 
-		for (auto it(new_groups.begin()); it != new_groups.end();) {
-			AE_ASSERT(*it != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
+		for (EntityGroup group : groups) {
+			AE_ASSERT(group != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
 
-			if (std::find(m_groups.begin(), m_groups.end(), *it) != m_groups.end())
-				it = new_groups.erase(it);
-			else {
-				EntityManager.RegisterEntityToGroup(*it, this);
-				it++;
+			if (!m_groups.Test(group)) {
+				AttachGroup(group);
+				changed_groups.push_back(group);
 			}
 		}
-		EntityManager.UpdateViews(this, m_groups, new_groups, {});
 
-		m_groups.insert(m_groups.end(), new_groups.begin(), new_groups.end());
+		EntityManager.UpdateGroupViews(this, changed_groups);
 	}
 	void Entity::RemoveFromGroups(const std::vector<EntityGroup>& groups) {
 
-		std::vector<EntityGroup> new_groups = RemoveDuplications(groups);
+		// detached groups are skipped, including duplicates of the list
+		std::vector<EntityGroup> changed_groups;
+		changed_groups.reserve(groups.size());
 
-		for (auto it(new_groups.begin()); it != new_groups.end();) {
-			AE_ASSERT(*it != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
+		for (EntityGroup group : groups) {
+			AE_ASSERT(group != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
 
-			if (std::find(m_groups.begin(), m_groups.end(), *it) == m_groups.end())
-				it = new_groups.erase(it);
-			else {
-				EntityManager.UnregisterEntityFromGroup(*it, this);
-				it++;
+			if (m_groups.Test(group)) {
+				DetachGroup(group);
+				changed_groups.push_back(group);
 			}
 		}
-		EntityManager.UpdateViews(this, m_groups, {}, new_groups);
 
-		for (EntityGroup group : new_groups)
-			m_groups.erase(std::find(m_groups.begin(), m_groups.end(), group));
+		EntityManager.UpdateGroupViews(this, changed_groups);
+	}
+
+	void Entity::AttachComponent(internal::ComponentTypeId id, Component* component) {
+		component->m_entity = this;
+		component->Initialize();
+
+		if (m_components.size() <= id)
+			m_components.resize(id + 1, nullptr);
+
+		m_components[id] = component;
+		m_signature.set(id);
+
+		EntityManager.m_storages[id]->RecordAdded(m_id);
+	}
+	void Entity::DetachComponent(internal::ComponentTypeId id) {
+		m_signature.reset(id);
+
+		EntityManager.EraseComponent(id, m_components[id]);
+		m_components[id] = nullptr;
+	}
+
+	void Entity::AttachGroup(EntityGroup group) {
+		EntityManager.RegisterEntityToGroup(group, this);
+		m_groups.Set(group);
+	}
+	void Entity::DetachGroup(EntityGroup group) {
+		EntityManager.UnregisterEntityFromGroup(group, this);
+		m_groups.Reset(group);
+	}
+
+	std::uint32_t& Entity::GetGroupPosition(EntityGroup group) {
+		auto location = std::find_if(m_group_positions.begin(), m_group_positions.end(), 
+			[group](const std::pair<EntityGroup, std::uint32_t>& position) -> bool { return position.first == group; });
+
+		return location->second;
+	}
+	void Entity::EraseGroupPosition(EntityGroup group) {
+		auto location = std::find_if(m_group_positions.begin(), m_group_positions.end(), 
+			[group](const std::pair<EntityGroup, std::uint32_t>& position) -> bool { return position.first == group; });
+
+		*location = m_group_positions.back();
+		m_group_positions.pop_back();
 	}
 
 	bool Entity::IsInGroup(EntityGroup group) {
 		AE_ASSERT(group != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
-		return (std::find(m_groups.begin(), m_groups.end(), group) != m_groups.end());
+		return m_groups.Test(group);
 	}
 	bool Entity::IsInAllGroups(const std::vector<EntityGroup>& groups) {
 		for (EntityGroup group : groups) {
 			AE_ASSERT(group != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
-			if (std::find(m_groups.begin(), m_groups.end(), group) == m_groups.end())
+			if (!m_groups.Test(group))
 				return false;
 		}
 
@@ -119,10 +145,10 @@ namespace ae {
 	bool Entity::IsInAnyGroup(const std::vector<EntityGroup>& groups) {
 		for (EntityGroup group : groups) {
 			AE_ASSERT(group != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
-			if (std::find(m_groups.begin(), m_groups.end(), group) != m_groups.end())
+			if (m_groups.Test(group))
 				return true;
 		}
 
 		return false;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Structure/EntityComponentSystem/EntityCommandBuffer.hpp"
+
+namespace ae {
+
+	EntityId EntityCommandBuffer::CreateEntity() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		EntityId pending = { m_next_pending++, c_pending_generation };
+
+		Command command;
+		command.type = CommandType::CreateEntity;
+		command.entity = pending;
+		m_commands.push_back(std::move(command));
+
+		return pending;
+	}
+	void EntityCommandBuffer::Kill(EntityId entity) {
+		Command command;
+		command.type = CommandType::Kill;
+		command.entity = entity;
+		Record(std::move(command));
+	}
+
+	void EntityCommandBuffer::AddToGroup(EntityId entity, EntityGroup group) {
+		AE_ASSERT(group != AllEntitiesGroup, "All entities belong to 'AllEntitiesGroup' (index 0), please do agree with it");
+
+		Command command;
+		command.type = CommandType::AddToGroup;
+		command.entity = entity;
+		command.group = group;
+		Record(std::move(command));
+	}
+	void EntityCommandBuffer::RemoveFromGroup(EntityId entity, EntityGroup group) {
+		AE_ASSERT(group != AllEntitiesGroup, "Removing 'AllEntitiesGroup' (index 0) is forbidden");
+
+		Command command;
+		command.type = CommandType::RemoveFromGroup;
+		command.entity = entity;
+		command.group = group;
+		Record(std::move(command));
+	}
+
+	size_t EntityCommandBuffer::GetSize() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_commands.size();
+	}
+
+	void EntityCommandBuffer::Record(Command&& command) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		AE_ASSERT(!IsPending(command.entity) || command.entity.index - m_first_pending < m_next_pending - m_first_pending, "Could not record command, pending entity handle has already been played back");
+
+		m_commands.push_back(std::move(command));
+	}
+	void EntityCommandBuffer::Take(std::vector<Command>& commands, std::uint32_t& first_pending) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		commands.swap(m_commands);
+		m_commands.clear();
+
+		first_pending = m_first_pending;
+		m_first_pending = m_next_pending;
+	}
+}
@@ -35,135 +35,346 @@
 #include "Structure/EntityComponentSystem/Entity.hpp"
 #include "Structure/Application.hpp"
 
+#include <chrono>
+
 namespace ae {
 	internal::EntityManagerType EntityManager = internal::CreateStructure<internal::EntityManagerType>();
 
 	namespace internal {
 
-//////// Registering ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		// ECS statistics do not depend on GLFW's timer, so that EntityManager can be measured without a window
+		static Time ToTime(std::chrono::steady_clock::duration duration) {
+			return Time(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+		}
 
-		void EntityManagerType::PushComponent(Component* component) {
-			ComponentTypeId id = typeid(*component);
+//////// Construction ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// find vec
-			auto it = m_components.find(id);
+		EntityManagerType::EntityManagerType() = default;
 
-			// push to vec
-			if (it == m_components.end())
-				// create if needed
-				m_components.insert({ id, {component} });
-			else
-				it->second.push_back(component);
+		EntityManagerType::~EntityManagerType() {
+			Clear();
+
+			for (Entity* entity : m_recycled_entities)
+				m_entity_pool.Destroy(entity);
+
+			for (ComponentStorageBase* storage : m_storages)
+				delete storage;
 		}
-		void EntityManagerType::EraseComponent(Component* component) {
+
+//////// Registering ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		void EntityManagerType::EraseComponent(ComponentTypeId id, Component* component) {
 
 			// find
-			auto it = m_components.find(typeid(*component));
-			auto location = std::find(it->second.begin(), it->second.end(), component);
+			ComponentStorageBase* storage = m_storages[id];
+
+			// erase from dense vector & destroy
+			storage->Erase(component);
+			storage->RecordRemoved(component->GetEntity()->m_id);
+			storage->Destroy(component);
+		}
+		void EntityManagerType::EraseComponents(Entity* entity) {
+			for (ComponentTypeId id = 0; id < entity->m_components.size(); id++)
+				if (entity->m_components[id])
+					EraseComponent(id, entity->m_components[id]);
+		}
 
-			// delete
-			delete *location;
-			it->second.erase(location);
+		Entity* EntityManagerType::AcquireEntity() {
 
-			// clean up
-			if (it->second.empty())
-				m_components.erase(it);
+			// take a recycled entity or a new one from the pool
+			if (m_recycled_entities.empty())
+				return m_entity_pool.Create();
+
+			Entity* entity = m_recycled_entities.back();
+			m_recycled_entities.pop_back();
+
+			return entity;
+		}
+
+		void EntityManagerType::RegisterEntity(Entity* entity) {
+
+			// take a free slot or create a new one
+			std::uint32_t index;
+
+			if (m_free_entity_slots.empty()) {
+				index = static_cast<std::uint32_t>(m_entity_slots.size());
+				m_entity_slots.emplace_back();
+			}
+			else {
+				index = m_free_entity_slots.back();
+				m_free_entity_slots.pop_back();
+			}
+
+			EntitySlot& slot = m_entity_slots[index];
+			slot.entity = entity;
+			entity->m_id = { index, slot.generation };
+
+			// push to AllEntitiesGroup, its positions are kept by slots
+			std::vector<Entity*>& entities = m_entities[AllEntitiesGroup];
+
+			slot.position = static_cast<std::uint32_t>(entities.size());
+			entities.push_back(entity);
+		}
+		void EntityManagerType::UnregisterEntity(Entity* entity) {
+
+			auto it = m_entities.find(AllEntitiesGroup);
+			std::vector<Entity*>& entities = it->second;
+
+			// swap with the last entity and pop
+			std::uint32_t position = m_entity_slots[entity->m_id.index].position;
+			Entity* last = entities.back();
+
+			entities[position] = last;
+			m_entity_slots[last->m_id.index].position = position;
+			entities.pop_back();
+
+			// AllEntitiesGroup is kept even if empty, so that its memory is reused
+		}
+		void EntityManagerType::DestroyEntity(Entity* entity) {
+
+			// invalidate handles & free the slot
+			EntitySlot& slot = m_entity_slots[entity->m_id.index];
+			slot.entity = nullptr;
+			slot.generation++;
+
+			m_free_entity_slots.push_back(entity->m_id.index);
+
+			// reset & recycle, vectors keep their capacity
+			entity->m_alive = true;
+			entity->m_marked_for_removal = false;
+			entity->m_signature.reset();
+			std::fill(entity->m_components.begin(), entity->m_components.end(), nullptr);
+			entity->m_groups.Clear();
+			entity->m_group_positions.clear();
+
+			m_recycled_entities.push_back(entity);
 		}
 
 		void EntityManagerType::RegisterEntityToGroup(EntityGroup group, Entity* entity) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not add entity to group, structural changes are not allowed during parallel iteration");
 			
-			// find vec
-			auto it = m_entities.find(group);
+			// find or create vec & push
+			InsertToGroup(m_entities[group], group, entity);
+		}
 
-			// push to vec
-			if (it == m_entities.end())
-				// create if needed
-				m_entities.insert({ group, {entity} });
-			else
-				it->second.push_back(entity);
+		void EntityManagerType::InsertToGroup(std::vector<Entity*>& entities, EntityGroup group, Entity* entity) {
+			entity->m_group_positions.push_back({ group, static_cast<std::uint32_t>(entities.size()) });
+			entities.push_back(entity);
+		}
+		void EntityManagerType::UpdateGroupPositions(EntityGroup group, const std::vector<Entity*>& entities) {
+			if (group == AllEntitiesGroup) {
+				for (size_t i = 0; i < entities.size(); i++)
+					m_entity_slots[entities[i]->m_id.index].position = static_cast<std::uint32_t>(i);
+			}
+			else {
+				for (size_t i = 0; i < entities.size(); i++)
+					entities[i]->GetGroupPosition(group) = static_cast<std::uint32_t>(i);
+			}
 		}
 
 		void EntityManagerType::UnregisterView(decltype(m_group_views)::iterator view) {
 			if (g_framework_settings.ecs_manage_advanced_views_manually)
-				view->second.clear();
-			else
+				view->second.Clear();
+			else {
+				UnindexView(*view);
 				m_group_views.erase(view);
+			}
 		}
 		void EntityManagerType::UnregisterView(decltype(m_component_views)::iterator view) {
 			if (g_framework_settings.ecs_manage_advanced_views_manually)
-				view->second.clear();
-			else
+				view->second.Clear();
+			else {
+				UnindexView(*view);
 				m_component_views.erase(view);
+			}
 		}
 
-		void EntityManagerType::UnregisterEntityFromGroup(EntityGroup group, Entity* entity) {
-			
-			//find
-			auto it = m_entities.find(group);
+		template <typename TagType, typename HistoryType>
+		void EntityManagerType::RememberEvictedView(HistoryType& history, const TagType& tag, size_t rebuild_count) {
+			if (history.size() >= c_evicted_view_history)
+				history.erase(history.begin());
 
-			// erase
-			it->second.erase(std::find(it->second.begin(), it->second.end(), entity));
+			history[tag] = rebuild_count;
+		}
+		template <typename TagType, typename HistoryType>
+		size_t EntityManagerType::ForgetEvictedView(HistoryType& history, const TagType& tag) {
+			auto location = history.find(tag);
 
-			// clean up
-			if (it->second.empty())
-				m_entities.erase(it);
+			if (location == history.end())
+				return 0;
+
+			const size_t rebuild_count = location->second;
+			history.erase(location);
+
+			m_evicted_view_rebuild_count++;
+			return rebuild_count;
 		}
 
-		decltype(EntityManagerType::m_group_views)::iterator EntityManagerType::UnregisterFromView(Entity* entity, decltype(m_group_views)::iterator view) {
-			auto it = std::find(view->second.begin(), view->second.end(), entity);
+		void EntityManagerType::EvictView(decltype(m_group_views)::iterator view) {
+			RememberEvictedView(m_evicted_group_views, view->first, view->second.rebuild_count);
+			UnregisterView(view);
+			m_view_eviction_count++;
+		}
+		void EntityManagerType::EvictView(decltype(m_component_views)::iterator view) {
+			RememberEvictedView(m_evicted_component_views, view->first, view->second.rebuild_count);
+			UnregisterView(view);
+			m_view_eviction_count++;
+		}
+
+		void EntityManagerType::EvictUnusedViews() {
+			const size_t max_age = g_framework_settings.ecs_advanced_view_max_age;
+			const size_t max_count = g_framework_settings.ecs_max_advanced_views;
+
+			if (g_framework_settings.ecs_manage_advanced_views_manually || (max_age == 0 && max_count == 0))
+				return;
+
+			const size_t now = m_refresh_stats.refresh_count;
+
+			// unused for too long
+			if (max_age > 0) {
+				for (auto view = m_group_views.begin(); view != m_group_views.end();) {
+					auto next = std::next(view);
+
+					if (now - view->second.GetLastUse() > max_age) {
+						EvictView(view);
+					}
+					view = next;
+				}
+				for (auto view = m_component_views.begin(); view != m_component_views.end();) {
+					auto next = std::next(view);
+
+					if (now - view->second.GetLastUse() > max_age) {
+						EvictView(view);
+					}
+					view = next;
+				}
+			}
+
+			// least recently used above the limit
+			if (max_count == 0 || CountAdvancedViews() <= max_count)
+				return;
+
+			std::vector<size_t> last_uses;
+			last_uses.reserve(CountAdvancedViews());
+
+			for (const auto& view : m_group_views)
+				last_uses.push_back(view.second.GetLastUse());
 
-			view->second.erase(it);
+			for (const auto& view : m_component_views)
+				last_uses.push_back(view.second.GetLastUse());
 
-			if (g_framework_settings.ecs_manage_advanced_views_manually && view->second.empty())
-				return m_group_views.erase(view);
+			// views used before the threshold are evicted, then those used at it until the limit is met
+			size_t excess = last_uses.size() - max_count;
+			std::nth_element(last_uses.begin(), last_uses.begin() + (excess - 1), last_uses.end());
+			const size_t threshold = last_uses[excess - 1];
 
-			return ++view;
+			for (int pass = 0; pass < 2 && excess > 0; pass++) {
+				auto is_evicted = [pass, threshold](const EntityView& view) -> bool {
+					return (pass == 0) ? (view.GetLastUse() < threshold) : (view.GetLastUse() == threshold);
+				};
+
+				for (auto view = m_group_views.begin(); view != m_group_views.end() && excess > 0;) {
+					auto next = std::next(view);
+
+					if (is_evicted(view->second)) {
+						EvictView(view);
+						excess--;
+					}
+					view = next;
+				}
+				for (auto view = m_component_views.begin(); view != m_component_views.end() && excess > 0;) {
+					auto next = std::next(view);
+
+					if (is_evicted(view->second)) {
+						EvictView(view);
+						excess--;
+					}
+					view = next;
+				}
+			}
 		}
-		decltype(EntityManagerType::m_component_views)::iterator EntityManagerType::UnregisterFromView(Entity* entity, decltype(m_component_views)::iterator view) {
-			auto it = std::find(view->second.begin(), view->second.end(), entity);
 
-			view->second.erase(it);
+		void EntityManagerType::UnregisterEntityFromGroup(EntityGroup group, Entity* entity) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not remove entity from group, structural changes are not allowed during parallel iteration");
+			
+			//find
+			auto it = m_entities.find(group);
+			std::vector<Entity*>& entities = it->second;
 
-			if (g_framework_settings.ecs_manage_advanced_views_manually && view->second.empty())
-				return m_component_views.erase(view);
+			// swap with the last entity and pop
+			std::uint32_t position = entity->GetGroupPosition(group);
+			Entity* last = entities.back();
 
-			return ++view;
+			entities[position] = last;
+			last->GetGroupPosition(group) = position;
+			entities.pop_back();
+
+			entity->EraseGroupPosition(group);
+
+			// an emptied group is kept, so that its memory is reused
 		}
-		decltype(EntityManagerType::m_group_views)::iterator EntityManagerType::RegisterView(GroupTag&& tag) {
-			if (m_entities.empty())
-				return m_group_views.end();
 
-			std::vector<Entity*> view;
+		decltype(EntityManagerType::m_group_views)::iterator EntityManagerType::RegisterView(GroupTag&& tag, bool allow_empty) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not register advanced view, views have to be registered before parallel iteration");
+
+			EntityView view;
+			const auto start = std::chrono::steady_clock::now();
 
 			// iterates through all entities to retrieve them in creation order
-			for (Entity* entity : m_entities.at(AllEntitiesGroup))
-				if (tag.IsCompatible(entity->m_groups))
-					view.push_back(entity);
+			if (!m_entities.empty()) {
+				for (Entity* entity : m_entities.at(AllEntitiesGroup))
+					if (tag.IsCompatible(entity->m_groups))
+						view.Insert(entity);
+			}
 
-			if (view.empty())
+			// failed registrations iterated through all entities as well, but are only counted in total
+			if (view.entities.empty() && !allow_empty) {
+				m_failed_view_registration_count++;
 				return m_group_views.end();
+			}
+
+			// statistics, a view rebuilt after eviction continues its count
+			view.update_count = 0;
+			view.SetLastUse(m_refresh_stats.refresh_count);
+			view.rebuild_count = 1 + ForgetEvictedView(m_evicted_group_views, tag);
+			view.last_rebuild_duration = std::chrono::steady_clock::now() - start;
+			m_view_rebuild_count++;
+
+			auto location = m_group_views.insert({ std::move(tag), std::move(view) }).first;
+			IndexView(*location);
 
-			return m_group_views.insert(
-				std::make_pair<GroupTag, std::vector<Entity*>>(std::move(tag), std::move(view))
-			).first;
+			return location;
 		}
-		decltype(EntityManagerType::m_component_views)::iterator EntityManagerType::RegisterView(ComponentTag&& tag) {
-			if (m_entities.empty())
-				return m_component_views.end();
+		decltype(EntityManagerType::m_component_views)::iterator EntityManagerType::RegisterView(ComponentTag&& tag, bool allow_empty) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not register advanced view, views have to be registered before parallel iteration");
 
-			std::vector<Entity*> view;
+			EntityView view;
+			const auto start = std::chrono::steady_clock::now();
 
 			// iterates through all entities to retrieve them in creation order
-			for (Entity* entity : m_entities.at(AllEntitiesGroup))
-				if (tag.IsCompatible(entity->m_components))
-					view.push_back(entity);
+			if (!m_entities.empty()) {
+				for (Entity* entity : m_entities.at(AllEntitiesGroup))
+					if (tag.IsCompatible(entity->m_signature))
+						view.Insert(entity);
+			}
 
-			if (view.empty())
+			// failed registrations iterated through all entities as well, but are only counted in total
+			if (view.entities.empty() && !allow_empty) {
+				m_failed_view_registration_count++;
 				return m_component_views.end();
+			}
 
-			return m_component_views.insert(
-				std::make_pair<ComponentTag, std::vector<Entity*>>(std::move(tag), std::move(view))
-			).first;
+			// statistics, a view rebuilt after eviction continues its count
+			view.update_count = 0;
+			view.SetLastUse(m_refresh_stats.refresh_count);
+			view.rebuild_count = 1 + ForgetEvictedView(m_evicted_component_views, tag);
+			view.last_rebuild_duration = std::chrono::steady_clock::now() - start;
+			m_view_rebuild_count++;
+
+			auto location = m_component_views.insert({ std::move(tag), std::move(view) }).first;
+			IndexView(*location);
+
+			return location;
 		}
 		decltype(EntityManagerType::m_component_views)::iterator EntityManagerType::FindOrRegisterView(ComponentTag&& tag) {
 			auto location = m_component_views.find(tag);
@@ -174,6 +385,8 @@ namespace ae {
 
 				return RegisterView(std::move(tag));
 			}
+
+			location->second.SetLastUse(m_refresh_stats.refresh_count);
 			return location;
 		}
 		decltype(EntityManagerType::m_group_views)::iterator EntityManagerType::FindOrRegisterView(GroupTag&& tag) {
@@ -185,113 +398,175 @@ namespace ae {
 
 				return RegisterView(std::move(tag));
 			}
+
+			location->second.SetLastUse(m_refresh_stats.refresh_count);
 			return location;
 		}
 
 //////// UpdateViews ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-		void EntityManagerType::UpdateViews(Entity* entity, const std::vector<EntityGroup>& old_groups, const std::vector<EntityGroup>& add_groups, const std::vector<EntityGroup>& remove_groups) {
-			
-			// create new_groups for compatibility checks
-			std::vector<EntityGroup> new_groups = old_groups;
-			new_groups.insert(new_groups.end(), add_groups.begin(), add_groups.end());
+		// the first component type a view includes, the signature's size if it includes none
+		static ComponentTypeId GetFirstIncluded(const ComponentTag& tag) {
+			ComponentTypeId id = 0;
 
-			for (EntityGroup group : remove_groups) {
-				auto it = std::find(new_groups.begin(), new_groups.end(), group);
-				if (it != new_groups.end())
-					new_groups.erase(it);
-			}
+			while (id < tag.include.size() && !tag.include.test(id))
+				id++;
 
-			// update
-			for (auto view(m_group_views.begin()); view != m_group_views.end();) {
-				
-				if (view->first.IsCompatible(old_groups)) {
-						
-					if (!view->first.IsCompatible(new_groups)) {
-								
-						view = UnregisterFromView(entity, view); \
-						continue; 
-					} 
-				} 
-				else if (view->first.IsCompatible(new_groups))
-					view->second.push_back(entity); 
-						
-				view++; 
+			return id;
+		}
+
+		void EntityManagerType::IndexView(GroupView& view) {
+			auto index = [this, &view](EntityGroup group) {
+				m_group_view_index[group].push_back(&view);
+			};
+
+			view.first.include.ForEach(index);
+			view.first.exclude.ForEach(index);
+
+			m_group_view_owners[view.first.include.First()].push_back(&view);
+		}
+		void EntityManagerType::IndexView(ComponentView& view) {
+			ComponentSignature mentioned = view.first.include | view.first.exclude;
+
+			for (ComponentTypeId id = 0; id < mentioned.size(); id++)
+				if (mentioned.test(id)) {
+					if (m_component_view_index.size() <= id)
+						m_component_view_index.resize(id + 1);
+
+					m_component_view_index[id].push_back(&view);
+				}
+
+			const ComponentTypeId owner = GetFirstIncluded(view.first);
+
+			if (owner == view.first.include.size())
+				m_excluding_component_views.push_back(&view);
+			else {
+				if (m_component_view_owners.size() <= owner)
+					m_component_view_owners.resize(owner + 1);
+
+				m_component_view_owners[owner].push_back(&view);
 			}
-			
 		}
 
-		void EntityManagerType::UpdateViews(Entity* entity, const std::vector<Component*>& old_components, Component* component, bool add_or_remove) {
-			
-			// create new_components for compatibility checks
-			std::vector<Component*> new_components = old_components;
+		void EntityManagerType::UnindexView(GroupView& view) {
+			auto unindex = [this, &view](EntityGroup group) {
+				auto location = m_group_view_index.find(group);
+				std::vector<GroupView*>& views = location->second;
 
-			if (add_or_remove)
-				new_components.push_back(component);
-			else
-				new_components.erase(std::find(new_components.begin(), new_components.end(), component));
+				views.erase(std::find(views.begin(), views.end(), &view));
 
-			// update
-			for (auto view(m_component_views.begin()); view != m_component_views.end();) {
+				if (views.empty())
+					m_group_view_index.erase(location);
+			};
 
-				if (view->first.IsCompatible(old_components)) {
+			view.first.include.ForEach(unindex);
+			view.first.exclude.ForEach(unindex);
 
-					if (!view->first.IsCompatible(new_components)) {
+			auto owner = m_group_view_owners.find(view.first.include.First());
+			owner->second.erase(std::find(owner->second.begin(), owner->second.end(), &view));
 
-						view = UnregisterFromView(entity, view); \
-							continue;
-					}
+			if (owner->second.empty())
+				m_group_view_owners.erase(owner);
+		}
+		void EntityManagerType::UnindexView(ComponentView& view) {
+			ComponentSignature mentioned = view.first.include | view.first.exclude;
+
+			for (ComponentTypeId id = 0; id < mentioned.size(); id++)
+				if (mentioned.test(id)) {
+					std::vector<ComponentView*>& views = m_component_view_index[id];
+					views.erase(std::find(views.begin(), views.end(), &view));
 				}
-				else if (view->first.IsCompatible(new_components))
-					view->second.push_back(entity);
 
-				view++;
-			}
+			const ComponentTypeId owner = GetFirstIncluded(view.first);
+			std::vector<ComponentView*>& owned = (owner == view.first.include.size()) ? m_excluding_component_views : m_component_view_owners[owner];
+
+			owned.erase(std::find(owned.begin(), owned.end(), &view));
 		}
-		void EntityManagerType::UpdateGroupViewsOnEntityRemoval(Entity* killed_entity) {
 
-			// component views
-			for (auto view(m_group_views.begin()); view != m_group_views.end();) {
+//////// UpdateViews ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-				if (view->first.IsCompatible(killed_entity->m_groups))
-					view = UnregisterFromView(killed_entity, view);
-				else
-					view++;
+		// incremental updates are timed only with 'ecs_detailed_statistics', as they are too frequent to measure them always
+		template <typename OperationType>
+		static void UpdateView(EntityView& view, const OperationType& operation) {
+			if (!g_framework_settings.ecs_detailed_statistics) {
+				operation();
+				return;
 			}
+
+			const auto start = std::chrono::steady_clock::now();
+			operation();
+			view.update_duration += std::chrono::steady_clock::now() - start;
 		}
-		void EntityManagerType::UpdateComponentViewsOnEntityRemoval(Entity* killed_entity) {
 
-			// component views
-			for (auto view(m_component_views.begin()); view != m_component_views.end();) {
+		static void UpdateViewMembership(EntityView& view, Entity* entity, bool compatible) {
+			bool contained = view.Contains(entity);
 
-				if (view->first.IsCompatible(killed_entity->m_components))
-					view = UnregisterFromView(killed_entity, view);
-				else
-					view++;
-			}
+			if (compatible && !contained)
+				UpdateView(view, [&view, entity]() { view.Insert(entity); });
+
+			else if (!compatible && contained)
+				UpdateView(view, [&view, entity]() { view.Erase(entity, g_framework_settings.ecs_preserve_view_order); });
 		}
-		void EntityManagerType::UpdateComponentViewsOnEntityRemoval(Entity* killed_entity, const ComponentTag& ignore_tag) {
 
-			// component views
-			for (auto view(m_component_views.begin()); view != m_component_views.end();) {
+		void EntityManagerType::UpdateGroupViews(Entity* entity, const EntityGroup* changed_groups, size_t changed_count) {
+
+			// only views mentioning changed groups can be affected
+			for (size_t i = 0; i < changed_count; i++) {
+				const EntityGroup group = changed_groups[i];
+
+				auto location = m_group_view_index.find(group);
+				if (location == m_group_view_index.end())
+					continue;
 
-				if (view->first.IsCompatible(killed_entity->m_components) && view->first != ignore_tag)
-					view = UnregisterFromView(killed_entity, view);
-				else
-					view++;
+				for (GroupView* view : location->second)
+					UpdateViewMembership(view->second, entity, view->first.IsCompatible(entity->m_groups));
 			}
 		}
-		void EntityManagerType::UpdateGroupViewsOnEntityRemoval(Entity* killed_entity, const GroupTag& ignore_tag) {
+		void EntityManagerType::UpdateComponentViews(Entity* entity, const ComponentSignature& changed_components) {
 
-			// group views
-			for (auto view(m_group_views.begin()); view != m_group_views.end();) {
+			// only views mentioning changed component types can be affected
+			for (ComponentTypeId id = 0; id < m_component_view_index.size(); id++) {
 
-				if (view->first.IsCompatible(killed_entity->m_groups) && view->first != ignore_tag)
-					view = UnregisterFromView(killed_entity, view);
-				else
-					view++;
+				if (!changed_components.test(id))
+					continue;
+
+				for (ComponentView* view : m_component_view_index[id])
+					UpdateViewMembership(view->second, entity, view->first.IsCompatible(entity->m_signature));
 			}
 		}
+
+		void EntityManagerType::UpdateGroupViewsOnEntityRemoval(Entity* killed_entity) {
+
+			// only views owned by the entity's groups can contain it, each view is visited once
+			auto erase = [this, killed_entity](EntityGroup group) {
+
+				auto location = m_group_view_owners.find(group);
+				if (location == m_group_view_owners.end())
+					return;
+
+				for (GroupView* view : location->second)
+					if (view->second.Contains(killed_entity))
+						UpdateView(view->second, [view, killed_entity]() { view->second.Erase(killed_entity, g_framework_settings.ecs_preserve_view_order); });
+			};
+
+			erase(AllEntitiesGroup);
+			killed_entity->m_groups.ForEach(erase);
+		}
+		void EntityManagerType::UpdateComponentViewsOnEntityRemoval(Entity* killed_entity) {
+
+			// only views owned by the entity's component types can contain it, each view is visited once
+			auto erase = [killed_entity](const std::vector<ComponentView*>& views) {
+				for (ComponentView* view : views)
+					if (view->second.Contains(killed_entity))
+						UpdateView(view->second, [view, killed_entity]() { view->second.Erase(killed_entity, g_framework_settings.ecs_preserve_view_order); });
+			};
+
+			erase(m_excluding_component_views);
+
+			for (ComponentTypeId id = 0; id < m_component_view_owners.size(); id++)
+				if (killed_entity->m_signature.test(id))
+					erase(m_component_view_owners[id]);
+		}
 		
 //////// Advanced View Manual Registering ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -304,16 +579,7 @@ namespace ae {
 			if (m_group_views.find(tag) != m_group_views.end())
 				return;
 
-			std::vector<Entity*> view;
-
-			// iterates through all entities to retrieve them in creation order
-			if (!m_entities.empty()) {
-				for (Entity* entity : m_entities.at(AllEntitiesGroup))
-					if (tag.IsCompatible(entity->m_groups))
-						view.push_back(entity);
-			}
-
-			m_group_views.insert(std::make_pair<GroupTag, std::vector<Entity*>>(std::move(tag), std::move(view)));
+			RegisterView(std::move(tag), true);
 		}
 		void EntityManagerType::RegisterAdvancedView(const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
 
@@ -324,53 +590,148 @@ namespace ae {
 			if (m_component_views.find(tag) != m_component_views.end())
 				return;
 
-			std::vector<Entity*> view;
-
-			// iterates through all entities to retrieve them in creation order
-			if (!m_entities.empty()) {
-				for (Entity* entity : m_entities.at(AllEntitiesGroup))
-					if (tag.IsCompatible(entity->m_components))
-						view.push_back(entity);
-			}
-
-			m_component_views.insert(std::make_pair<ComponentTag, std::vector<Entity*>>(std::move(tag), std::move(view)));
+			RegisterView(std::move(tag), true);
 		}
 
 
 		void EntityManagerType::UnregisterAdvancedView(const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups) {
 
+			AE_ASSERT(!IsIteratingInParallel(), "Could not unregister advanced view, views cannot be unregistered during parallel iteration");
 			AE_ASSERT(g_framework_settings.ecs_manage_advanced_views_manually, "Could not unregister advanced view, 'ecs_manage_advanced_views_manually' was not set to true when initializing the application");
 
-			GroupTag tag = { groups, exclude_groups };
+			auto location = m_group_views.find(GroupTag(groups, exclude_groups));
 
-			if (m_group_views.find(tag) != m_group_views.end())
-				m_group_views.erase(tag);
+			if (location != m_group_views.end()) {
+				UnindexView(*location);
+				m_group_views.erase(location);
+			}
 		}
 		void EntityManagerType::UnregisterAdvancedView(const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
 
+			AE_ASSERT(!IsIteratingInParallel(), "Could not unregister advanced view, views cannot be unregistered during parallel iteration");
 			AE_ASSERT(g_framework_settings.ecs_manage_advanced_views_manually, "Could not unregister advanced view, 'ecs_manage_advanced_views_manually' was not set to true when initializing the application");
 
-			ComponentTag tag = { components.m_components, exclude_components.m_components };
+			auto location = m_component_views.find(ComponentTag(components.m_components, exclude_components.m_components));
 
-			if (m_component_views.find(tag) != m_component_views.end())
-				m_component_views.erase(tag);
+			if (location != m_component_views.end()) {
+				UnindexView(*location);
+				m_component_views.erase(location);
+			}
 		}
 		void EntityManagerType::UnregisterAllAdvancedViews() {
 
+			AE_ASSERT(!IsIteratingInParallel(), "Could not unregister advanced view, views cannot be unregistered during parallel iteration");
 			AE_ASSERT(g_framework_settings.ecs_manage_advanced_views_manually, "Could not unregister advanced views, 'ecs_manage_advanced_views_manually' was not set to true when initializing the application");
 
 			m_group_views.clear();
 			m_component_views.clear();
+
+			m_group_view_index.clear();
+			m_component_view_index.clear();
+			m_group_view_owners.clear();
+			m_component_view_owners.clear();
+			m_excluding_component_views.clear();
 		}
 
 //////// Entity & Group Creation ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 		Entity& EntityManagerType::CreateEntity() {
-			Entity* entity = new Entity();
-			RegisterEntityToGroup(AllEntitiesGroup, entity);
+			AE_ASSERT(!IsIteratingInParallel(), "Could not create entity, structural changes are not allowed during parallel iteration");
+
+			Entity* entity = AcquireEntity();
+			RegisterEntity(entity);
 			return *entity;
 		}
 
+		// grows geometrically, so that repeated bursts do not reallocate every time
+		template <typename ElementType>
+		static void ReserveAdditional(std::vector<ElementType>& vec, size_t additional) {
+			const size_t required = vec.size() + additional;
+
+			if (vec.capacity() < required)
+				vec.reserve(std::max(required, vec.capacity() * 2));
+		}
+
+		std::vector<EntityId> EntityManagerType::CreateEntities(size_t count, const Prefab& prefab) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not create entities, structural changes are not allowed during parallel iteration");
+
+			std::vector<EntityId> ids;
+
+			if (count == 0)
+				return ids;
+
+			ids.reserve(count);
+
+			// reserve storages & pools once
+			for (const Prefab::ComponentEntry& entry : prefab.m_components) {
+				ComponentStorageBase* storage = entry.find_or_create_storage(*this);
+				const size_t required = storage->components.size() + count;
+
+				if (storage->components.capacity() < required)
+					storage->Reserve(std::max(required, storage->components.capacity() * 2));
+			}
+
+			if (count > m_recycled_entities.size())
+				m_entity_pool.Reserve(m_entity_pool.GetMemoryStats().live_count + count - m_recycled_entities.size());
+
+			ReserveAdditional(m_entity_slots, count);
+			ReserveAdditional(m_entities[AllEntitiesGroup], count);
+
+			// create entities, advanced views are not updated yet
+			std::vector<Entity*>& batch = m_created_entities;
+			batch.clear();
+			batch.reserve(count);
+
+			for (size_t i = 0; i < count; i++) {
+				Entity* entity = AcquireEntity();
+				RegisterEntity(entity);
+
+				entity->m_groups = prefab.m_groups;
+
+				for (const Prefab::ComponentEntry& entry : prefab.m_components)
+					entity->AttachComponent(entry.id, entry.create(*this));
+
+				batch.push_back(entity);
+				ids.push_back(entity->m_id);
+			}
+
+			auto batch_begin = batch.cbegin();
+			auto batch_end = batch.cend();
+
+			// groups
+			prefab.m_groups.ForEach([this, &batch](EntityGroup group) {
+				std::vector<Entity*>& entities = m_entities[group];
+				ReserveAdditional(entities, batch.size());
+
+				for (Entity* entity : batch)
+					InsertToGroup(entities, group, entity);
+			});
+
+			// advanced views - all entities of the batch are alike, check each view once
+			for (ComponentTypeId id = 0; id < m_component_view_index.size(); id++) {
+
+				if (!prefab.m_signature.test(id))
+					continue;
+
+				for (ComponentView* view : m_component_view_index[id])
+					if (!view->second.Contains(*batch_begin) && view->first.IsCompatible(prefab.m_signature))
+						view->second.Insert(batch_begin, batch_end);
+			}
+
+			prefab.m_groups.ForEach([this, &prefab, batch_begin, batch_end](EntityGroup group) {
+
+				auto location = m_group_view_index.find(group);
+				if (location == m_group_view_index.end())
+					return;
+
+				for (GroupView* view : location->second)
+					if (!view->second.Contains(*batch_begin) && view->first.IsCompatible(prefab.m_groups))
+						view->second.Insert(batch_begin, batch_end);
+			});
+
+			return ids;
+		}
+
 		EntityGroup EntityManagerType::CreateGroup() {
 			return ++m_next_group;
 		}
@@ -378,102 +739,109 @@ namespace ae {
 //////// Clear & Remove ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 		void EntityManagerType::RemoveAliveEntity(Entity& entity) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not remove entity, structural changes are not allowed during parallel iteration");
 
 			UpdateGroupViewsOnEntityRemoval(&entity);
 			UpdateComponentViewsOnEntityRemoval(&entity);
 
-			auto& entities = m_entities.at(AllEntitiesGroup);
+			// delete components
+			EraseComponents(&entity);
 
-			for (auto it(entities.begin()); it != entities.end(); it++)
-				if (*it == &entity) {
+			// remove from groups
+			UnregisterEntity(&entity);
 
-					// delete components
-					for (Component* comp : entity.m_components)
-						EraseComponent(comp);
+			entity.m_groups.ForEach([this, &entity](EntityGroup group) {
+				UnregisterEntityFromGroup(group, &entity);
+			});
 
-					// remove from groups
-					UnregisterEntityFromGroup(AllEntitiesGroup, &entity);
+			// delete entity
+			DestroyEntity(&entity);
+		}
+		void EntityManagerType::RemoveAliveEntity(EntityId id) {
+			Entity* entity = GetEntity(id);
 
-					for (EntityGroup group : entity.m_groups)
-						UnregisterEntityFromGroup(group, &entity);
+			AE_ASSERT(entity, "Could not remove entity, handle '" << id.index << ':' << id.generation << "' is no longer valid");
 
-					// delete entity
-					delete& entity;
-					break;
-				}
+			if (entity)
+				RemoveAliveEntity(*entity);
+		}
+
+		Entity* EntityManagerType::GetEntity(EntityId id) const {
+			if (id.index >= m_entity_slots.size())
+				return nullptr;
+
+			const EntitySlot& slot = m_entity_slots[id.index];
+			return (slot.generation == id.generation) ? slot.entity : nullptr;
+		}
+		bool EntityManagerType::IsValid(EntityId id) const {
+			return (GetEntity(id) != nullptr);
 		}
 
 		void EntityManagerType::ClearAll() {
 			
 			if (g_framework_settings.ecs_manage_advanced_views_manually) {
 				for (auto& view : m_group_views)
-					view.second.clear();
+					view.second.Clear();
 
 				for (auto& view : m_component_views)
-					view.second.clear();
+					view.second.Clear();
 			}
 			else {
 				m_group_views.clear();
 				m_component_views.clear();
+
+				m_group_view_index.clear();
+				m_component_view_index.clear();
+				m_group_view_owners.clear();
+				m_component_view_owners.clear();
+				m_excluding_component_views.clear();
 			}
 
+			m_evicted_group_views.clear();
+			m_evicted_component_views.clear();
+
 			if (!m_entities.empty())
 				for (auto& e : m_entities.at(AllEntitiesGroup))
-					delete e;
+					DestroyEntity(e);
 
-			m_entities.clear();
+			// groups keep their memory
+			for (auto& group : m_entities)
+				group.second.clear();
 
-			for (auto& p : m_components)
-				for (auto& c : p.second)
-					delete c;
+			// storages keep their memory
+			for (ComponentStorageBase* storage : m_storages)
+				if (storage) {
+					for (Component* component : storage->components)
+						storage->RecordRemoved(component->GetEntity()->m_id);
 
-			m_components.clear();
+					storage->Clear();
+				}
 		}
 
 		void EntityManagerType::Clear(EntityGroup group) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not clear entities, structural changes are not allowed during parallel iteration");
 
-			// find
-			auto location = m_entities.find(group);
-
-			if (location == m_entities.end())
-				return;
-
-			// AllEntitiesGroup - special case
-			if (location->first == AllEntitiesGroup) {
+			// AllEntitiesGroup - special case, clears component storages as well
+			if (group == AllEntitiesGroup) {
 				ClearAll();
 				return;
 			}
 
-			// iterate through entities
-			for (auto ent_it(location->second.begin()); ent_it != location->second.end(); ent_it++) {
-
-				Entity* entity = *ent_it;
-
-				// remove from views
-				UpdateGroupViewsOnEntityRemoval(entity);
-				UpdateComponentViewsOnEntityRemoval(entity);
-
-				// remove from groups
-				UnregisterEntityFromGroup(AllEntitiesGroup, entity);
-
-				for (EntityGroup e_group : entity->m_groups){
-					if (group != e_group)
-						UnregisterEntityFromGroup(e_group, entity);
-				}
+			// find
+			auto location = m_entities.find(group);
 
-				// delete components
-				for (Component* e_comp : entity->m_components) {
-					EraseComponent(e_comp);
-				}
+			if (location == m_entities.end())
+				return;
 
-				// clean the heap space
-				delete entity;
-			}
+			// mark & remove
+			for (Entity* entity : location->second)
+				entity->m_marked_for_removal = true;
 
-			// clean up
-			m_entities.erase(location);
+			RemoveMarkedEntities(location->second.size());
 		}
 		void EntityManagerType::Clear(const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not clear entities, structural changes are not allowed during parallel iteration");
+
 			AE_ECS_ADVANCED_GROUP_VIEW_DEBUG_LOGIC_TEST(
 				groups, exclude_groups,
 				"Could not clear entities, invalid groups' sizes",
@@ -494,66 +862,31 @@ namespace ae {
 				if (all_entities == m_entities.end())
 					return;
 
-				// iterate through entities
-				for (auto ent_it(all_entities->second.begin()); ent_it != all_entities->second.end();) {
+				// mark entities belonging to the view & remove
+				size_t marked_count = 0;
 
-					Entity* entity = *ent_it;
-					
-					// check if entity belongs to a view
+				for (Entity* entity : all_entities->second)
 					if (tag.IsCompatible(entity->m_groups)) {
-
-						// remove from views
-						UpdateGroupViewsOnEntityRemoval(entity);
-						UpdateComponentViewsOnEntityRemoval(entity);
-
-						// remove from groups
-						for (EntityGroup e_group : entity->m_groups)
-							UnregisterEntityFromGroup(e_group, entity);
-
-						// delete components
-						for (Component* e_comp : entity->m_components)
-							EraseComponent(e_comp);
-
-						// clean heap space
-						delete entity;
-
-						// next entity
-						ent_it = all_entities->second.erase(ent_it);
+						entity->m_marked_for_removal = true;
+						marked_count++;
 					}
-					else
-						ent_it++;
-				}
+
+				RemoveMarkedEntities(marked_count);
 				return;
 			}
-			// view registered
-			for (auto ent_it(location->second.begin()); ent_it != location->second.end(); ent_it++) {
-
-				Entity* entity = *ent_it;
-
-				// remove from views
-				UpdateGroupViewsOnEntityRemoval(entity, tag);
-				UpdateComponentViewsOnEntityRemoval(entity);
-
-				// remove from groups
-				UnregisterEntityFromGroup(AllEntitiesGroup, entity);
-
-				for (EntityGroup e_group : entity->m_groups)
-					UnregisterEntityFromGroup(e_group, entity);
-
-				// delete components
-				for (Component* e_comp : entity->m_components)
-					EraseComponent(e_comp);
 
-				// clean heap space
-				delete entity;
+			// view registered - mark & remove
+			for (Entity* entity : location->second.entities)
+				entity->m_marked_for_removal = true;
 
-			}
+			RemoveMarkedEntities(location->second.entities.size());
 			
 			// clean up
 			UnregisterView(location);
-
 		}
 		void EntityManagerType::Clear(const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not clear entities, structural changes are not allowed during parallel iteration");
+
 			AE_ECS_ADVANCED_COMP_VIEW_DEBUG_LOGIC_TEST(
 				components.m_components, exclude_components.m_components,
 				"Could not clear entities, invalid ComponentPacks' sizes",
@@ -574,93 +907,265 @@ namespace ae {
 				if (all_entities == m_entities.end())
 					return;
 
-				// iterate through entities
-				for (auto ent_it(all_entities->second.begin()); ent_it != all_entities->second.end();) {
+				// mark entities belonging to the view & remove
+				size_t marked_count = 0;
+
+				for (Entity* entity : all_entities->second)
+					if (tag.IsCompatible(entity->m_signature)) {
+						entity->m_marked_for_removal = true;
+						marked_count++;
+					}
+
+				RemoveMarkedEntities(marked_count);
+				return;
+			}
+
+			// view registered - mark & remove
+			for (Entity* entity : location->second.entities)
+				entity->m_marked_for_removal = true;
 
-					Entity* entity = *ent_it;
+			RemoveMarkedEntities(location->second.entities.size());
 
-					// check if entity belongs to a view
-					if (tag.IsCompatible(entity->m_components)) {
+			// clean up
+			UnregisterView(location);
+		}
+
+		void EntityManagerType::Refresh() {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not refresh entities, structural changes are not allowed during parallel iteration");
+
+			const auto start = std::chrono::steady_clock::now();
+
+			// also measures the age of advanced views
+			m_refresh_stats.refresh_count++;
+
+			m_refresh_stats.last_played_command_count = m_command_buffer.GetSize();
+			PlayBackCommands();
+
+			// mark killed entities & remove
+			size_t marked_count = 0;
+
+			if (!m_entities.empty()) {
+				for (Entity* entity : m_entities.at(AllEntitiesGroup))
+					if (!entity->IsAlive()) {
+						entity->m_marked_for_removal = true;
+						marked_count++;
+					}
+
+				RemoveMarkedEntities(marked_count);
+			}
+
+			// changes recorded until now become visible to queries
+			for (ComponentStorageBase* storage : m_storages)
+				if (storage)
+					storage->SwapChanges();
+
+			EvictUnusedViews();
+
+			// statistics
+			const Time time = ToTime(std::chrono::steady_clock::now() - start);
+
+			m_refresh_stats.last_removed_entity_count = marked_count;
+			m_refresh_stats.last_time = time;
+			m_refresh_stats.total_time += time;
+			m_refresh_stats.max_time = std::max(m_refresh_stats.max_time, time);
+		}
+
+		void EntityManagerType::RemoveMarkedEntities(size_t marked_count) {
+			if (marked_count == 0)
+				return;
+
+			auto all_entities = m_entities.find(AllEntitiesGroup);
+			std::vector<Entity*>& entities = all_entities->second;
+
+			auto is_marked = [](const Entity* entity) -> bool { return entity->m_marked_for_removal; };
+
+			// views - shifting entities of a view is linear anyway, compact it once instead
+			if (g_framework_settings.ecs_preserve_view_order && marked_count > 1) {
+				for (auto& view : m_group_views)
+					UpdateView(view.second, [&view, &is_marked]() { view.second.EraseIf(is_marked); });
 
-						// remove from views
+				for (auto& view : m_component_views)
+					UpdateView(view.second, [&view, &is_marked]() { view.second.EraseIf(is_marked); });
+			}
+			else {
+				for (Entity* entity : entities)
+					if (entity->m_marked_for_removal) {
 						UpdateGroupViewsOnEntityRemoval(entity);
 						UpdateComponentViewsOnEntityRemoval(entity);
+					}
+			}
+
+			// compact every affected storage and group in a single pass, keeping the order of the remaining elements
+			ComponentSignature affected_components;
+			GroupSet affected_groups;
 
-						// remove from groups
-						for (EntityGroup e_group : entity->m_groups)
-							UnregisterEntityFromGroup(e_group, entity);
+			for (Entity* entity : entities)
+				if (entity->m_marked_for_removal) {
+					affected_components |= entity->m_signature;
+					affected_groups |= entity->m_groups;
+				}
 
-						// delete components
-						for (Component* e_comp : entity->m_components)
-							EraseComponent(e_comp);
+			for (ComponentTypeId id = 0; id < m_storages.size(); id++) {
+				if (!affected_components.test(id))
+					continue;
 
-						// clean heap space
-						delete entity;
+				ComponentStorageBase* storage = m_storages[id];
+				std::vector<Component*>& components = storage->components;
+				size_t kept_count = 0;
 
-						// next entity
-						ent_it = all_entities->second.erase(ent_it);
+				for (Component* component : components) {
+					if (component->GetEntity()->m_marked_for_removal) {
+						storage->RecordRemoved(component->GetEntity()->m_id);
+						storage->Destroy(component);
 					}
 					else
-						ent_it++;
+						components[kept_count++] = component;
 				}
-				return;
-			}
-			// view registered
-			for (auto ent_it(location->second.begin()); ent_it != location->second.end(); ent_it++) {
 
-				Entity* entity = *ent_it;
-
-				// remove from views
-				UpdateGroupViewsOnEntityRemoval(entity);
-				UpdateComponentViewsOnEntityRemoval(entity, tag);
+				components.resize(kept_count);
+				storage->UpdatePositions();
+			}
 
-				// remove from groups
-				UnregisterEntityFromGroup(AllEntitiesGroup, entity);
+			// emptied groups are kept, so that their memory is reused
+			affected_groups.ForEach([this, &is_marked](EntityGroup group) {
+				if (group == AllEntitiesGroup)
+					return;
 
-				for (EntityGroup e_group : entity->m_groups)
-					UnregisterEntityFromGroup(e_group, entity);
+				std::vector<Entity*>& group_entities = m_entities.at(group);
+				group_entities.erase(std::remove_if(group_entities.begin(), group_entities.end(), is_marked), group_entities.end());
+				UpdateGroupPositions(group, group_entities);
+			});
 
-				// delete components
-				for (Component* e_comp : entity->m_components)
-					EraseComponent(e_comp);
+			// compact AllEntitiesGroup, keeping the order of entities
+			size_t kept_count = 0;
 
-				// clean heap space
-				delete entity;
+			for (Entity* entity : entities) {
+				if (entity->m_marked_for_removal) {
+					DestroyEntity(entity);
+					continue;
+				}
 
+				m_entity_slots[entity->m_id.index].position = static_cast<std::uint32_t>(kept_count);
+				entities[kept_count++] = entity;
 			}
 
-			// clean up
-			UnregisterView(location);
+			entities.resize(kept_count);
 		}
 
-		void EntityManagerType::Refresh() {
-			if (m_entities.empty())
+		void EntityManagerType::PlayBackCommands() {
+			typedef EntityCommandBuffer::CommandType CommandType;
+
+			std::vector<EntityCommandBuffer::Command>& commands = m_played_commands;
+			std::uint32_t first_pending;
+			m_command_buffer.Take(commands, first_pending);
+
+			if (commands.empty())
 				return;
 
-			auto& entities = m_entities.at(AllEntitiesGroup);
+			// create entities first and resolve pending handles
+			std::vector<EntityId> created;
+
+			for (EntityCommandBuffer::Command& command : commands)
+				if (command.type == CommandType::CreateEntity)
+					created.push_back(CreateEntity().GetId());
+
+			// handles of earlier playbacks precede first_pending, their commands are dropped
+			for (EntityCommandBuffer::Command& command : commands)
+				if (EntityCommandBuffer::IsPending(command.entity)) {
+					const std::uint32_t pending = command.entity.index - first_pending;
+					command.entity = (pending < created.size()) ? created[pending] : InvalidEntityId;
+				}
+
+			// group commands by entity, keeping the order of recording
+			std::stable_sort(commands.begin(), commands.end(), 
+				[](const EntityCommandBuffer::Command& command1, const EntityCommandBuffer::Command& command2) -> bool {
+					return command1.entity < command2.entity;
+			});
 
-			for (auto it(entities.begin()); it != entities.end();) {
-				if (!(*it)->IsAlive()) {
-					Entity* entity = *it;
+			// apply, update views once per entity
+			std::vector<EntityGroup> changed_groups;
 
-					// remove from views
-					UpdateGroupViewsOnEntityRemoval(entity);
-					UpdateComponentViewsOnEntityRemoval(entity);
+			for (size_t begin = 0; begin < commands.size();) {
 
-					// delete components
-					for (Component* comp : entity->m_components)
-						EraseComponent(comp);
+				size_t end = begin + 1;
+				while (end < commands.size() && commands[end].entity == commands[begin].entity)
+					end++;
 
-					// remove from groups
-					for (EntityGroup group : entity->m_groups)
-						UnregisterEntityFromGroup(group, entity);
+				Entity* entity = GetEntity(commands[begin].entity);
 
-					it = entities.erase(it);
-					delete entity;
+				// entity has been removed
+				if (!entity) {
+					begin = end;
+					continue;
 				}
-				else
-					it++;
+
+				ComponentSignature changed_components;
+				changed_groups.clear();
+
+				for (size_t i = begin; i < end; i++) {
+					EntityCommandBuffer::Command& command = commands[i];
+
+					switch (command.type) {
+
+					case CommandType::Kill:
+						entity->Kill();
+						break;
+
+					case CommandType::AddComponent:
+						AE_ASSERT(!entity->m_signature.test(command.component), "Could not play back command, entity already has the added component");
+
+						if (!entity->m_signature.test(command.component)) {
+							entity->AttachComponent(command.component, command.create(*this));
+							changed_components.set(command.component);
+						}
+						break;
+
+					case CommandType::RemoveComponent:
+						AE_ASSERT(entity->m_signature.test(command.component), "Could not play back command, entity does not have the removed component");
+
+						if (entity->m_signature.test(command.component)) {
+							entity->DetachComponent(command.component);
+							changed_components.set(command.component);
+						}
+						break;
+
+					case CommandType::AddToGroup:
+						AE_ASSERT(!entity->IsInGroup(command.group), "Could not play back command, entity already belongs to group '" << command.group << '\'');
+
+						if (!entity->IsInGroup(command.group)) {
+							entity->AttachGroup(command.group);
+
+							if (std::find(changed_groups.begin(), changed_groups.end(), command.group) == changed_groups.end())
+								changed_groups.push_back(command.group);
+						}
+						break;
+
+					case CommandType::RemoveFromGroup:
+						AE_ASSERT(entity->IsInGroup(command.group), "Could not play back command, entity does not belong to group '" << command.group << '\'');
+
+						if (entity->IsInGroup(command.group)) {
+							entity->DetachGroup(command.group);
+
+							if (std::find(changed_groups.begin(), changed_groups.end(), command.group) == changed_groups.end())
+								changed_groups.push_back(command.group);
+						}
+						break;
+
+					default:
+						break;
+					}
+				}
+
+				if (changed_components.any())
+					UpdateComponentViews(entity, changed_components);
+
+				if (!changed_groups.empty())
+					UpdateGroupViews(entity, changed_groups);
+
+				begin = end;
 			}
+
+			commands.clear();
 		}
 
 
@@ -693,7 +1198,7 @@ namespace ae {
 				return;
 
 			// iterate
-			for (Entity* entity : location->second)
+			for (Entity* entity : location->second.entities)
 				operation(*entity);
 		}
 		void EntityManagerType::ViewEntities(const std::function<void(Entity&)>& operation, const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
@@ -711,14 +1216,16 @@ namespace ae {
 				return;
 
 			// iterate
-			for (Entity* entity : location->second)
+			for (Entity* entity : location->second.entities)
 				operation(*entity);
 		}
 
 //////// Sorting ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 		void EntityManagerType::SortView(const std::function<bool(Entity&, Entity&)>& compare, EntityGroup group) {
-			
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort entities, sorting is not allowed during parallel iteration");
+
 			// find
 			auto it = m_entities.find(group);
 
@@ -731,9 +1238,12 @@ namespace ae {
 					return compare(*entity1, *entity2);
 			});
 
+			UpdateGroupPositions(group, it->second);
 		}
 		void EntityManagerType::SortView(const std::function<bool(Entity&, Entity&)>& compare, const std::set<EntityGroup>& groups, const std::set<EntityGroup>& exclude_groups) {
-			
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort entities, sorting is not allowed during parallel iteration");
+
 			// check for logic
 			AE_ECS_ADVANCED_GROUP_VIEW_DEBUG_LOGIC_TEST(
 				groups, exclude_groups,
@@ -747,13 +1257,18 @@ namespace ae {
 				return;
 
 			// sort
-			std::sort(location->second.begin(), location->second.end(),
+			std::sort(location->second.entities.begin(), location->second.entities.end(),
 				[&compare](Entity* entity1, Entity* entity2) -> bool {
 					return compare(*entity1, *entity2);
 			});
 
+			location->second.UpdatePositions();
+			location->second.sort_count++;
 		}
 		void EntityManagerType::SortView(const std::function<bool(Entity&, Entity&)>& compare, const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
+
+			AE_ASSERT(!IsIteratingInParallel(), "Could not sort entities, sorting is not allowed during parallel iteration");
+
 			// check for logic
 			AE_ECS_ADVANCED_COMP_VIEW_DEBUG_LOGIC_TEST(
 				components.m_components, exclude_components.m_components,
@@ -767,10 +1282,13 @@ namespace ae {
 				return;
 
 			// sort
-			std::sort(location->second.begin(), location->second.end(),
+			std::sort(location->second.entities.begin(), location->second.entities.end(),
 				[&compare](Entity* entity1, Entity* entity2) -> bool {
 					return compare(*entity1, *entity2);
 			});
+
+			location->second.UpdatePositions();
+			location->second.sort_count++;
 		}
 
 //////// Retrieve Iterators ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -801,7 +1319,7 @@ namespace ae {
 				return {};
 
 			// return
-			return { location->second.begin(), location->second.end() };
+			return { location->second.entities.begin(), location->second.entities.end() };
 		}
 		std::pair< std::vector<Entity*>::iterator, std::vector<Entity*>::iterator> EntityManagerType::GetBeginEndIterators(const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
 			// check for logic
@@ -817,14 +1335,15 @@ namespace ae {
 				return {};
 
 			// return
-			return { location->second.begin(), location->second.end() };
+			return { location->second.entities.begin(), location->second.entities.end() };
 		}
 
 		size_t EntityManagerType::CountComponents() const {
 			unsigned int count = 0;
 
-			for (auto& p : m_components)
-				count += p.second.size();
+			for (ComponentStorageBase* storage : m_storages)
+				if (storage)
+					count += storage->components.size();
 
 			return count;
 		}
@@ -850,7 +1369,7 @@ namespace ae {
 				return 0;
 
 			// return
-			return location->second.size();
+			return location->second.entities.size();
 
 		}
 		size_t EntityManagerType::CountEntities(const ComponentPack<>& components, const ComponentPack<>& exclude_components) {
@@ -861,10 +1380,132 @@ namespace ae {
 				return 0;
 
 			// return
-			return location->second.size();
+			return location->second.entities.size();
 		}
 		size_t EntityManagerType::CountAdvancedViews() const {
 			return m_group_views.size() + m_component_views.size();
 		}
+
+//////// Memory ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		void EntityManagerType::ReserveEntities(size_t count) {
+			m_entity_pool.Reserve(count);
+			m_recycled_entities.reserve(count);
+
+			m_entity_slots.reserve(count);
+			m_free_entity_slots.reserve(count);
+
+			m_entities[AllEntitiesGroup].reserve(count);
+		}
+
+		PoolMemoryStats EntityManagerType::GetEntityMemoryStats() const {
+
+			// recycled entities are constructed, but not in use
+			PoolMemoryStats stats = m_entity_pool.GetMemoryStats();
+			stats.live_count -= m_recycled_entities.size();
+
+			return stats;
+		}
+
+//////// Statistics ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		EntityManagerStats EntityManagerType::GetStats() const {
+			EntityManagerStats stats;
+			GetStats(stats);
+
+			return stats;
+		}
+
+		void EntityManagerType::GetStats(EntityManagerStats& stats) const {
+
+			// entities
+			stats.entity_count = CountEntities();
+			stats.group_count = std::count_if(m_entities.begin(), m_entities.end(), [](const auto& group) { return group.first == AllEntitiesGroup || !group.second.empty(); });
+			stats.entity_memory = GetEntityMemoryStats();
+
+			stats.allocation_count = stats.entity_memory.chunk_count;
+			stats.reserved_bytes = stats.entity_memory.reserved_bytes + m_entity_slots.capacity() * sizeof(EntitySlot);
+
+			for (const auto& group : m_entities)
+				stats.reserved_bytes += group.second.capacity() * sizeof(Entity*);
+
+			// component types
+			stats.component_types.clear();
+
+			for (ComponentTypeId id = 0; id < m_storages.size(); id++) {
+				const ComponentStorageBase* storage = m_storages[id];
+				if (!storage)
+					continue;
+
+				ComponentTypeStats type;
+				type.id = id;
+				type.type_name = storage->GetTypeName();
+				type.component_size = storage->GetComponentSize();
+				type.component_count = storage->components.size();
+				type.dense_bytes = storage->components.capacity() * sizeof(Component*);
+				type.memory = storage->GetMemoryStats();
+
+				stats.allocation_count += type.memory.chunk_count;
+				stats.reserved_bytes += type.memory.reserved_bytes + type.dense_bytes;
+				stats.component_types.push_back(type);
+			}
+
+			// advanced views, vectors of previous views are reused
+			size_t view_count = 0;
+
+			const size_t refresh_count = m_refresh_stats.refresh_count;
+
+			auto describe_view = [&stats, &view_count, refresh_count](const EntityView& view) -> AdvancedViewStats& {
+				if (stats.advanced_views.size() == view_count)
+					stats.advanced_views.emplace_back();
+
+				AdvancedViewStats& view_stats = stats.advanced_views[view_count++];
+				view_stats.groups.clear();
+				view_stats.exclude_groups.clear();
+				view_stats.components.clear();
+				view_stats.exclude_components.clear();
+
+				view_stats.entity_count = view.entities.size();
+				view_stats.reserved_bytes = view.GetReservedBytes();
+				view_stats.rebuild_count = view.rebuild_count;
+				view_stats.last_rebuild_time = ToTime(view.last_rebuild_duration);
+				view_stats.update_count = view.update_count;
+				view_stats.update_time = ToTime(view.update_duration);
+				view_stats.sort_count = view.sort_count;
+				view_stats.idle_refresh_count = refresh_count - view.GetLastUse();
+
+				stats.reserved_bytes += view_stats.reserved_bytes;
+				return view_stats;
+			};
+
+			for (const auto& view : m_group_views) {
+				AdvancedViewStats& view_stats = describe_view(view.second);
+				view_stats.is_group_view = true;
+
+				view.first.include.ForEach([&view_stats](EntityGroup group) { view_stats.groups.push_back(group); });
+				view.first.exclude.ForEach([&view_stats](EntityGroup group) { view_stats.exclude_groups.push_back(group); });
+			}
+			for (const auto& view : m_component_views) {
+				AdvancedViewStats& view_stats = describe_view(view.second);
+				view_stats.is_group_view = false;
+
+				for (ComponentTypeId id = 0; id < view.first.include.size(); id++) {
+					if (view.first.include.test(id))
+						view_stats.components.push_back(id);
+
+					if (view.first.exclude.test(id))
+						view_stats.exclude_components.push_back(id);
+				}
+			}
+
+			stats.advanced_views.resize(view_count);
+			stats.view_rebuild_count = m_view_rebuild_count;
+			stats.failed_view_registration_count = m_failed_view_registration_count;
+			stats.view_eviction_count = m_view_eviction_count;
+			stats.evicted_view_rebuild_count = m_evicted_view_rebuild_count;
+
+			// refresh
+			stats.refresh = m_refresh_stats;
+		}
 	}
 }
@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Structure/EntityComponentSystem/EntityView.hpp"
+#include "Structure/EntityComponentSystem/Entity.hpp"
+
+#include <algorithm>
+
+namespace ae {
+	namespace internal {
+
+		bool EntityView::Contains(const Entity* entity) const {
+			std::uint32_t index = entity->GetId().index;
+			return (index < m_positions.size() && m_positions[index] != c_no_position);
+		}
+
+		void EntityView::Insert(Entity* entity) {
+			std::uint32_t index = entity->GetId().index;
+
+			if (index >= m_positions.size())
+				m_positions.resize(index + 1, c_no_position);
+
+			m_positions[index] = static_cast<std::uint32_t>(entities.size());
+			entities.push_back(entity);
+			update_count++;
+		}
+		void EntityView::Insert(std::vector<Entity*>::const_iterator begin, std::vector<Entity*>::const_iterator end) {
+			entities.reserve(entities.size() + (end - begin));
+
+			for (auto it = begin; it != end; it++)
+				Insert(*it);
+		}
+
+		void EntityView::Erase(Entity* entity, bool preserve_order) {
+			std::uint32_t& position = m_positions[entity->GetId().index];
+
+			// shift following entities
+			if (preserve_order) {
+				entities.erase(entities.begin() + position);
+
+				for (size_t i = position; i < entities.size(); i++)
+					m_positions[entities[i]->GetId().index] = static_cast<std::uint32_t>(i);
+			}
+
+			// swap with the last entity and pop
+			else {
+				Entity* last = entities.back();
+
+				entities[position] = last;
+				m_positions[last->GetId().index] = position;
+				entities.pop_back();
+			}
+
+			position = c_no_position;
+			update_count++;
+		}
+
+		void EntityView::EraseIf(const std::function<bool(const Entity*)>& predicate) {
+			size_t kept_count = 0;
+
+			for (Entity* entity : entities) {
+				if (predicate(entity)) {
+					m_positions[entity->GetId().index] = c_no_position;
+					continue;
+				}
+
+				m_positions[entity->GetId().index] = static_cast<std::uint32_t>(kept_count);
+				entities[kept_count++] = entity;
+			}
+
+			update_count += entities.size() - kept_count;
+			entities.resize(kept_count);
+		}
+
+		void EntityView::Clear() {
+			// entities may have already been destroyed, do not access them
+			std::fill(m_positions.begin(), m_positions.end(), c_no_position);
+			entities.clear();
+		}
+
+		void EntityView::UpdatePositions() {
+			for (size_t i = 0; i < entities.size(); i++)
+				m_positions[entities[i]->GetId().index] = static_cast<std::uint32_t>(i);
+		}
+
+		size_t EntityView::GetReservedBytes() const {
+			return entities.capacity() * sizeof(Entity*) + m_positions.capacity() * sizeof(std::uint32_t);
+		}
+
+		void EntityView::SetLastUse(size_t refresh_count) {
+
+			// views used every tick are written once per tick, not by every system using them
+			if (m_last_use.value.load(std::memory_order_relaxed) != refresh_count)
+				m_last_use.value.store(refresh_count, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,464 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Preprocessor.hpp"
+#include "Structure/EntityComponentSystem/Snapshot.hpp"
+#include "System/LogError.hpp"
+
+#include <fstream>
+
+// File layout (native byte order), entities are referred to by their position in AllEntitiesGroup:
+//
+//	char[4]  magic "AESN"
+//	uint32   version
+//	uint64   next group
+//	uint64   entity count
+//	uint64   killed entity count, uint32[] killed entities
+//	uint64   group count
+//		uint64 group, uint64 entity count, uint32[] entities
+//	uint64   component type count
+//		uint32 name size, char[] name, uint64 record size (0 - custom), uint64 component count, uint32[] entities,
+//		record size > 0: one block of records | record size = 0: (uint64 size, byte[] data) per component
+
+namespace {
+	constexpr char c_snapshot_magic[4] = { 'A', 'E', 'S', 'N' };
+	constexpr std::uint32_t c_snapshot_version = 2;
+
+	template <typename ValueType>
+	void Write(std::vector<std::uint8_t>& bytes, const ValueType& value) {
+		const std::uint8_t* value_bytes = reinterpret_cast<const std::uint8_t*>(&value);
+		bytes.insert(bytes.end(), value_bytes, value_bytes + sizeof(ValueType));
+	}
+
+	// bounds-checked reading of a loaded file
+	class SnapshotReader {
+	public:
+		SnapshotReader(const std::vector<std::uint8_t>& bytes) : m_position(bytes.data()), m_end(bytes.data() + bytes.size()) {}
+
+		template <typename ValueType>
+		bool Read(ValueType& value) {
+			if (!CanRead(sizeof(ValueType)))
+				return false;
+
+			std::memcpy(&value, m_position, sizeof(ValueType));
+			m_position += sizeof(ValueType);
+			return true;
+		}
+
+		// returns nullptr if there are not enough bytes left
+		const std::uint8_t* Skip(std::uint64_t size) {
+			if (!CanRead(size))
+				return nullptr;
+
+			const std::uint8_t* position = m_position;
+			m_position += size;
+			return position;
+		}
+
+		bool IsAtEnd() const { return m_position == m_end; }
+
+	private:
+		const std::uint8_t* m_position;
+		const std::uint8_t* m_end;
+
+		bool CanRead(std::uint64_t size) const { return size <= std::uint64_t(m_end - m_position); }
+	};
+
+	std::uint32_t ReadIndex(const std::uint8_t* indices, std::uint64_t i) {
+		std::uint32_t index;
+		std::memcpy(&index, indices + i * sizeof(std::uint32_t), sizeof(std::uint32_t));
+		return index;
+	}
+}
+
+namespace ae {
+	namespace internal {
+
+//////// Registering ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		void EntityManagerType::RegisterSnapshotComponent(SnapshotComponent&& info) {
+
+			for (SnapshotComponent& registered : m_snapshot_components) {
+
+				// registering a type again replaces its functions
+				if (registered.id == info.id) {
+					registered = std::move(info);
+					return;
+				}
+
+				AE_ASSERT(registered.name != info.name, "Could not register snapshot component, name '" << info.name << "' is already used by another component type");
+			}
+
+			m_snapshot_components.push_back(std::move(info));
+		}
+
+//////// Saving ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		bool EntityManagerType::SaveSnapshot(const std::string& filename) const {
+
+			std::vector<std::uint8_t> bytes;
+
+			auto all_entities = m_entities.find(AllEntitiesGroup);
+			const std::uint64_t entity_count = (all_entities == m_entities.end()) ? 0 : all_entities->second.size();
+
+			// position in AllEntitiesGroup identifies an entity in the file
+			auto write_index = [this, &bytes](const Entity* entity) {
+				Write(bytes, m_entity_slots[entity->m_id.index].position);
+			};
+
+			// header
+			bytes.insert(bytes.end(), c_snapshot_magic, c_snapshot_magic + sizeof(c_snapshot_magic));
+			Write(bytes, c_snapshot_version);
+			Write(bytes, std::uint64_t(m_next_group));
+			Write(bytes, entity_count);
+
+			// killed entities, not removed by Refresh yet
+			std::uint64_t killed_count = 0;
+
+			if (all_entities != m_entities.end())
+				for (const Entity* entity : all_entities->second)
+					if (!entity->m_alive)
+						killed_count++;
+
+			Write(bytes, killed_count);
+
+			if (killed_count > 0)
+				for (const Entity* entity : all_entities->second)
+					if (!entity->m_alive)
+						write_index(entity);
+
+			// groups, empty ones kept for their memory are skipped
+			std::uint64_t group_count = 0;
+
+			for (auto& group : m_entities)
+				if (group.first != AllEntitiesGroup && !group.second.empty())
+					group_count++;
+
+			Write(bytes, group_count);
+
+			for (auto& group : m_entities) {
+				if (group.first == AllEntitiesGroup || group.second.empty())
+					continue;
+
+				Write(bytes, std::uint64_t(group.first));
+				Write(bytes, std::uint64_t(group.second.size()));
+
+				for (const Entity* entity : group.second)
+					write_index(entity);
+			}
+
+			// components
+			std::uint64_t type_count = 0;
+
+			for (const SnapshotComponent& info : m_snapshot_components)
+				if (info.id < m_storages.size() && m_storages[info.id])
+					type_count++;
+
+			Write(bytes, type_count);
+
+			for (const SnapshotComponent& info : m_snapshot_components) {
+				if (info.id >= m_storages.size() || !m_storages[info.id])
+					continue;
+
+				const std::vector<Component*>& components = m_storages[info.id]->components;
+
+				Write(bytes, std::uint32_t(info.name.size()));
+				bytes.insert(bytes.end(), info.name.begin(), info.name.end());
+				Write(bytes, std::uint64_t(info.record_size));
+				Write(bytes, std::uint64_t(components.size()));
+
+				for (const Component* component : components)
+					write_index(component->GetEntity());
+
+				// one block of records
+				if (info.record_size > 0) {
+					bytes.reserve(bytes.size() + components.size() * info.record_size);
+
+					for (const Component* component : components)
+						info.save(*component, bytes);
+				}
+
+				// size-prefixed data
+				else {
+					for (const Component* component : components) {
+						const size_t size_position = bytes.size();
+						Write(bytes, std::uint64_t(0));
+
+						info.save(*component, bytes);
+
+						const std::uint64_t size = bytes.size() - size_position - sizeof(std::uint64_t);
+						std::memcpy(bytes.data() + size_position, &size, sizeof(std::uint64_t));
+					}
+				}
+			}
+
+			// write
+			std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+			if (file.good())
+				file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+			if (!file.good()) {
+				AE_WARNING("Could not save snapshot '" << filename << '\'');
+				LogError("[Aether] Could not save snapshot '" + filename + '\'', false);
+				return false;
+			}
+
+			return true;
+		}
+
+//////// Loading ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		bool EntityManagerType::LoadSnapshot(const std::string& filename) {
+			AE_ASSERT(!IsIteratingInParallel(), "Could not load snapshot, structural changes are not allowed during parallel iteration");
+
+			auto fail = [&filename](const std::string& reason) -> bool {
+				AE_WARNING("Could not load snapshot '" << filename << "', " << reason);
+				LogError("[Aether] Could not load snapshot '" + filename + "', " + reason, false);
+				return false;
+			};
+
+			// read the whole file at once
+			std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+
+			if (!file.good())
+				return fail("file could not be opened");
+
+			std::vector<std::uint8_t> bytes(static_cast<size_t>(file.tellg()));
+
+			file.seekg(0);
+			file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+			if (!file.good())
+				return fail("file could not be read");
+
+			file.close();
+
+			// parse & validate everything before touching EntityManager
+			SnapshotReader reader(bytes);
+
+			char magic[sizeof(c_snapshot_magic)];
+			std::uint32_t version;
+			std::uint64_t next_group, entity_count, group_count, type_count;
+
+			if (!reader.Read(magic) || std::memcmp(magic, c_snapshot_magic, sizeof(magic)) != 0)
+				return fail("it is not a snapshot file");
+
+			if (!reader.Read(version) || version != c_snapshot_version)
+				return fail("unsupported version");
+
+			if (!reader.Read(next_group) || !reader.Read(entity_count) || entity_count > 0xFFFFFFFF)
+				return fail("file is corrupted");
+
+			auto valid_indices = [entity_count](const std::uint8_t* indices, std::uint64_t count) -> bool {
+				for (std::uint64_t i = 0; i < count; i++)
+					if (ReadIndex(indices, i) >= entity_count)
+						return false;
+
+				return true;
+			};
+
+			std::uint64_t killed_count;
+			const std::uint8_t* killed_indices;
+
+			if (!reader.Read(killed_count) || killed_count > entity_count)
+				return fail("file is corrupted");
+
+			killed_indices = reader.Skip(killed_count * sizeof(std::uint32_t));
+
+			if (!killed_indices || !valid_indices(killed_indices, killed_count))
+				return fail("file is corrupted");
+
+			struct GroupSection {
+				EntityGroup group;
+				std::uint64_t count;
+				const std::uint8_t* indices;
+			};
+			std::vector<GroupSection> groups;
+
+			if (!reader.Read(group_count))
+				return fail("file is corrupted");
+
+			for (std::uint64_t g = 0; g < group_count; g++) {
+				std::uint64_t group, count;
+
+				if (!reader.Read(group) || !reader.Read(count) || group == AllEntitiesGroup || count > entity_count)
+					return fail("file is corrupted");
+
+				const std::uint8_t* indices = reader.Skip(count * sizeof(std::uint32_t));
+
+				if (!indices || !valid_indices(indices, count))
+					return fail("file is corrupted");
+
+				groups.push_back({ static_cast<EntityGroup>(group), count, indices });
+			}
+
+			struct ComponentSection {
+				const SnapshotComponent* info;
+				std::uint64_t count;
+				const std::uint8_t* indices;
+				const std::uint8_t* data;
+			};
+			std::vector<ComponentSection> components;
+
+			if (!reader.Read(type_count))
+				return fail("file is corrupted");
+
+			for (std::uint64_t t = 0; t < type_count; t++) {
+				std::uint32_t name_size;
+				std::uint64_t record_size, count;
+
+				const std::uint8_t* name = (reader.Read(name_size)) ? reader.Skip(name_size) : nullptr;
+
+				if (!name || !reader.Read(record_size) || !reader.Read(count) || count > entity_count || record_size > bytes.size())
+					return fail("file is corrupted");
+
+				const std::uint8_t* indices = reader.Skip(count * sizeof(std::uint32_t));
+
+				if (!indices || !valid_indices(indices, count))
+					return fail("file is corrupted");
+
+				// data
+				const std::uint8_t* data = nullptr;
+
+				if (record_size > 0)
+					data = reader.Skip(count * record_size);
+
+				else {
+					data = reader.Skip(0);
+
+					for (std::uint64_t i = 0; i < count && data; i++) {
+						std::uint64_t size;
+						if (!reader.Read(size) || !reader.Skip(size))
+							data = nullptr;
+					}
+				}
+
+				if (!data)
+					return fail("file is corrupted");
+
+				// find registered type
+				const std::string type_name(reinterpret_cast<const char*>(name), name_size);
+
+				auto info = std::find_if(m_snapshot_components.begin(), m_snapshot_components.end(), 
+					[&type_name](const SnapshotComponent& info) { return info.name == type_name; });
+
+				if (info == m_snapshot_components.end()) {
+					AE_WARNING("Snapshot '" << filename << "' contains unregistered component type '" << type_name << "', it has been skipped");
+					continue;
+				}
+
+				if (info->record_size != record_size)
+					return fail("size of component '" + type_name + "' does not match");
+
+				components.push_back({ &*info, count, indices, data });
+			}
+
+			if (!reader.IsAtEnd())
+				return fail("file is corrupted");
+
+			// rebuild
+			Clear();
+			ReserveEntities(static_cast<size_t>(entity_count));
+
+			std::vector<Entity*>& entities = m_created_entities;
+			entities.clear();
+			entities.reserve(static_cast<size_t>(entity_count));
+
+			for (std::uint64_t i = 0; i < entity_count; i++) {
+				Entity* entity = AcquireEntity();
+				RegisterEntity(entity);
+				entities.push_back(entity);
+			}
+
+			for (const GroupSection& section : groups) {
+				std::vector<Entity*>& group = m_entities[section.group];
+				group.reserve(static_cast<size_t>(section.count));
+
+				for (std::uint64_t i = 0; i < section.count; i++) {
+					Entity* entity = entities[ReadIndex(section.indices, i)];
+
+					if (!entity->IsInGroup(section.group)) {
+						entity->m_groups.Set(section.group);
+						InsertToGroup(group, section.group, entity);
+					}
+				}
+			}
+
+			for (const ComponentSection& section : components) {
+				ComponentStorageBase* storage = section.info->find_or_create_storage(*this);
+				storage->Reserve(static_cast<size_t>(section.count));
+
+				// fixed size records
+				if (section.info->record_size > 0) {
+					section.info->load_records(*this, entities, section.indices, section.data, static_cast<size_t>(section.count));
+					continue;
+				}
+
+				// size-prefixed data
+				const std::uint8_t* data = section.data;
+
+				for (std::uint64_t i = 0; i < section.count; i++) {
+					Entity* entity = entities[ReadIndex(section.indices, i)];
+
+					std::uint64_t size;
+					std::memcpy(&size, data, sizeof(std::uint64_t));
+					data += sizeof(std::uint64_t);
+
+					if (!entity->m_signature.test(section.info->id))
+						section.info->load(*this, *entity, data, static_cast<size_t>(size));
+
+					data += size;
+				}
+			}
+
+			m_next_group = std::max(m_next_group, static_cast<EntityGroup>(next_group));
+
+			// advanced views - views registered manually or by components' Initialize
+			for (auto& view : m_group_views)
+				for (Entity* entity : entities)
+					if (!view.second.Contains(entity) && view.first.IsCompatible(entity->m_groups))
+						view.second.Insert(entity);
+
+			for (auto& view : m_component_views)
+				for (Entity* entity : entities)
+					if (!view.second.Contains(entity) && view.first.IsCompatible(entity->m_signature))
+						view.second.Insert(entity);
+
+			// killed entities stay killed until the next Refresh
+			for (std::uint64_t i = 0; i < killed_count; i++)
+				entities[ReadIndex(killed_indices, i)]->Kill();
+
+			return true;
+		}
+	}
+}
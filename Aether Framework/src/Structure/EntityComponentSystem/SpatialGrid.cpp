@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Preprocessor.hpp"
+#include "Structure/EntityComponentSystem/SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ae {
+
+	SpatialGrid::SpatialGrid(float cell_size)
+		: m_cell_size(cell_size)
+	{
+		AE_ASSERT(cell_size > 0.f, "Could not create spatial grid, cell size must be greater than 0");
+	}
+
+	void SpatialGrid::Insert(EntityId entity, const FloatRect& bounds) {
+		AE_ASSERT(entity != InvalidEntityId, "Could not insert invalid entity into spatial grid");
+
+		if (entity.index >= m_entries.size())
+			m_entries.resize(size_t(entity.index) + 1);
+
+		Entry& entry = m_entries[entity.index];
+
+		const bool oversized = (bounds.width > m_cell_size || bounds.height > m_cell_size);
+		const std::uint64_t cell = oversized ? 0 : GetCellKey(bounds);
+
+		// still in the same cell
+		if (entry.id == entity && entry.oversized == oversized && entry.cell == cell) {
+			entry.bounds = bounds;
+			return;
+		}
+
+		// moved, or the slot is left by an entity of an older generation
+		if (entry.id != InvalidEntityId)
+			Unlink(entity.index);
+		else
+			m_count++;
+
+		entry.id = entity;
+		entry.bounds = bounds;
+		entry.cell = cell;
+		entry.oversized = oversized;
+
+		Link(entity.index);
+	}
+	void SpatialGrid::Remove(EntityId entity) {
+		if (!Contains(entity))
+			return;
+
+		Unlink(entity.index);
+
+		m_entries[entity.index].id = InvalidEntityId;
+		m_count--;
+	}
+	void SpatialGrid::Clear() {
+		m_entries.clear();
+		m_cells.clear();
+		m_cell_count = 0;
+		m_first_oversized = NoEntry;
+		m_count = 0;
+	}
+
+	bool SpatialGrid::Contains(EntityId entity) const {
+		return (entity.index < m_entries.size() && m_entries[entity.index].id == entity);
+	}
+
+	//////// Queries ////////////////////////////////////////////////////////////////////////////////////////////
+	void SpatialGrid::QueryRect(const FloatRect& rect, std::vector<EntityId>& result) const {
+		Search(rect, [&rect](const FloatRect& bounds) -> bool {
+			return (
+				bounds.left <= rect.left + rect.width && rect.left <= bounds.left + bounds.width &&
+				bounds.top <= rect.top + rect.height && rect.top <= bounds.top + bounds.height
+			);
+		}, result);
+	}
+	void SpatialGrid::QueryRadius(const Vector2f& center, float radius, std::vector<EntityId>& result) const {
+		const FloatRect area(center.x - radius, center.y - radius, radius * 2.f, radius * 2.f);
+
+		Search(area, [&center, radius](const FloatRect& bounds) -> bool {
+
+			// distance from the center to the closest point of the bounds
+			const float dx = std::max(std::max(bounds.left - center.x, center.x - (bounds.left + bounds.width)), 0.f);
+			const float dy = std::max(std::max(bounds.top - center.y, center.y - (bounds.top + bounds.height)), 0.f);
+
+			return (dx * dx + dy * dy <= radius * radius);
+		}, result);
+	}
+	void SpatialGrid::QueryPoint(const Vector2f& point, std::vector<EntityId>& result) const {
+		Search(FloatRect(point.x, point.y, 0.f, 0.f), [&point](const FloatRect& bounds) -> bool {
+			return bounds.IsPointInside(point);
+		}, result);
+	}
+
+	std::vector<EntityId> SpatialGrid::QueryRect(const FloatRect& rect) const {
+		std::vector<EntityId> result;
+		QueryRect(rect, result);
+		return result;
+	}
+	std::vector<EntityId> SpatialGrid::QueryRadius(const Vector2f& center, float radius) const {
+		std::vector<EntityId> result;
+		QueryRadius(center, radius, result);
+		return result;
+	}
+	std::vector<EntityId> SpatialGrid::QueryPoint(const Vector2f& point) const {
+		std::vector<EntityId> result;
+		QueryPoint(point, result);
+		return result;
+	}
+
+	//////// Cells ////////////////////////////////////////////////////////////////////////////////////////////
+	std::uint64_t SpatialGrid::GetCellKey(int x, int y) {
+		return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+	}
+	int SpatialGrid::GetCellCoordinate(float position) const {
+
+		// keep ranges far from integer limits
+		constexpr float limit = float(1 << 30);
+
+		const float cell = std::floor(position / m_cell_size);
+
+		if (!(cell > -limit))
+			return -(1 << 30);
+		if (!(cell < limit))
+			return (1 << 30);
+
+		return int(cell);
+	}
+	std::uint64_t SpatialGrid::GetCellKey(const FloatRect& bounds) const {
+		return GetCellKey(
+			GetCellCoordinate(bounds.left + bounds.width * 0.5f),
+			GetCellCoordinate(bounds.top + bounds.height * 0.5f)
+		);
+	}
+
+	static size_t HashCellKey(std::uint64_t key) {
+		key ^= key >> 33;
+		key *= 0xFF51AFD7ED558CCDull;
+		key ^= key >> 33;
+		return size_t(key);
+	}
+
+	const SpatialGrid::Cell* SpatialGrid::FindCell(std::uint64_t key) const {
+		if (m_cells.empty())
+			return nullptr;
+
+		const size_t mask = m_cells.size() - 1;
+
+		for (size_t i = HashCellKey(key) & mask; m_cells[i].used; i = (i + 1) & mask)
+			if (m_cells[i].key == key)
+				return &m_cells[i];
+
+		return nullptr;
+	}
+	SpatialGrid::Cell& SpatialGrid::FindOrCreateCell(std::uint64_t key) {
+
+		// keep the table at most half full
+		if ((m_cell_count + 1) * 2 > m_cells.size()) {
+			std::vector<Cell> cells(std::max<size_t>(m_cells.size() * 2, 64));
+			std::swap(cells, m_cells);
+
+			const size_t mask = m_cells.size() - 1;
+
+			for (const Cell& cell : cells)
+				if (cell.used) {
+					size_t i = HashCellKey(cell.key) & mask;
+					while (m_cells[i].used)
+						i = (i + 1) & mask;
+
+					m_cells[i] = cell;
+				}
+		}
+
+		const size_t mask = m_cells.size() - 1;
+
+		size_t i = HashCellKey(key) & mask;
+		for (; m_cells[i].used; i = (i + 1) & mask)
+			if (m_cells[i].key == key)
+				return m_cells[i];
+
+		// create
+		m_cells[i].key = key;
+		m_cells[i].used = true;
+		m_cell_count++;
+
+		return m_cells[i];
+	}
+
+	void SpatialGrid::Link(std::uint32_t index) {
+		Entry& entry = m_entries[index];
+		std::uint32_t& first = entry.oversized ? m_first_oversized : FindOrCreateCell(entry.cell).first;
+
+		entry.previous = NoEntry;
+		entry.next = first;
+
+		if (first != NoEntry)
+			m_entries[first].previous = index;
+
+		first = index;
+	}
+	void SpatialGrid::Unlink(std::uint32_t index) {
+		Entry& entry = m_entries[index];
+
+		if (entry.next != NoEntry)
+			m_entries[entry.next].previous = entry.previous;
+
+		if (entry.previous != NoEntry)
+			m_entries[entry.previous].next = entry.next;
+		else if (entry.oversized)
+			m_first_oversized = entry.next;
+		else
+			FindOrCreateCell(entry.cell).first = entry.next; // the cell exists
+
+		entry.previous = entry.next = NoEntry;
+	}
+}
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Structure/EntityComponentSystem/SystemScheduler.hpp"
+#include "Structure/EntityComponentSystem/EntityManager.hpp"
+#include "Structure/JobPool.hpp"
+#include "System/Clock.hpp"
+
+#include <algorithm>
+
+namespace ae {
+
+	internal::SystemSchedulerType SystemScheduler = internal::CreateStructure<internal::SystemSchedulerType>();
+
+	namespace internal {
+
+		SystemSchedulerType::~SystemSchedulerType() {
+			RemoveAllSystems();
+		}
+
+		System& SystemSchedulerType::GetSystem(size_t position) const {
+			AE_ASSERT(GetSize() > position, "System at position '" << position << "' does not exist");
+			return *m_systems.at(position);
+		}
+
+		size_t SystemSchedulerType::GetSize() const {
+			return m_systems.size();
+		}
+
+		void SystemSchedulerType::RemoveSystem(size_t position) {
+			AE_ASSERT(position < GetSize(), "Could not remove system on position '" << position << "', vector out of range");
+
+			delete m_systems.at(position);
+			m_systems.erase(m_systems.begin() + position);
+		}
+		void SystemSchedulerType::RemoveSystem(System& system) {
+			auto system_it = std::find(m_systems.begin(), m_systems.end(), &system);
+			AE_ASSERT(system_it != m_systems.end(), "Could not remove system, invalid system");
+
+			delete *system_it;
+			m_systems.erase(system_it);
+		}
+
+		void SystemSchedulerType::RemoveAllSystems() {
+			for (System* system : m_systems)
+				delete system;
+
+			m_systems.clear();
+		}
+
+		const Time& SystemSchedulerType::GetUpdateTime() const {
+			return m_update_time;
+		}
+		size_t SystemSchedulerType::GetWaveCount() const {
+			return m_wave_count;
+		}
+
+//////// Scheduling ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		bool SystemSchedulerType::Conflict(const System& system1, const System& system2) {
+			if (system1.IsExclusive() || system2.IsExclusive())
+				return true;
+
+			return (system1.m_writes & (system2.m_reads | system2.m_writes)).any() 
+				|| (system2.m_writes & system1.m_reads).any();
+		}
+
+		void SystemSchedulerType::RunSystem(System& system) {
+			Clock clock;
+			system.Update();
+			system.m_update_time = clock.GetElapsedTime();
+		}
+
+		void SystemSchedulerType::BuildWaves() {
+			m_levels.assign(m_systems.size(), 0);
+			m_wave_count = 0;
+
+			for (std::vector<System*>& wave : m_waves)
+				wave.clear();
+
+			// each system runs one wave after the last earlier system it conflicts with
+			for (size_t i = 0; i < m_systems.size(); i++) {
+				if (!m_systems[i]->m_enabled)
+					continue;
+
+				size_t level = 0;
+
+				for (size_t j = 0; j < i; j++)
+					if (m_systems[j]->m_enabled && Conflict(*m_systems[i], *m_systems[j]))
+						level = std::max(level, m_levels[j] + 1);
+
+				m_levels[i] = level;
+
+				if (m_waves.size() <= level)
+					m_waves.resize(level + 1);
+
+				m_waves[level].push_back(m_systems[i]);
+				m_wave_count = std::max(m_wave_count, level + 1);
+			}
+		}
+
+		void SystemSchedulerType::Update() {
+			Clock clock;
+
+			BuildWaves();
+
+			for (size_t level = 0; level < m_wave_count; level++) {
+				std::vector<System*>& wave = m_waves[level];
+
+				// single system - run on the main thread, structural changes are rejected unless it is exclusive,
+				// so that they do not depend on how systems were packed into waves
+				if (wave.size() == 1) {
+					System& system = *wave.front();
+
+					if (system.IsExclusive())
+						RunSystem(system);
+					else {
+						EntityManagerType::ParallelIterationScope parallel_iteration(EntityManager);
+						RunSystem(system);
+					}
+					continue;
+				}
+
+				// run in parallel, reject structural changes meanwhile
+				m_jobs.clear();
+
+				for (System* system : wave)
+					m_jobs.push_back([system]() { RunSystem(*system); });
+
+				EntityManagerType::ParallelIterationScope parallel_iteration(EntityManager);
+				JobPool.Run(m_jobs);
+			}
+
+			m_update_time = clock.GetElapsedTime();
+		}
+	}
+}
@@ -0,0 +1,429 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Core/Preprocessor.hpp"
+#include "Structure/EntityComponentSystem/TransformHierarchy.hpp"
+#include "Structure/EntityComponentSystem/Entity.hpp"
+#include "Structure/JobPool.hpp"
+
+#include <algorithm>
+
+namespace ae {
+
+//////// Nodes ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void TransformHierarchy::Insert(EntityId entity, const Transform2D& local, EntityId parent) {
+		AE_ASSERT(entity != InvalidEntityId, "Could not insert invalid entity into transform hierarchy");
+		AE_ASSERT(parent == InvalidEntityId || Contains(parent), "Could not find parent in transform hierarchy");
+		AE_ASSERT(parent != entity, "Could not insert entity into transform hierarchy, it cannot be its own parent");
+
+		if (entity.index >= m_slots.size())
+			m_slots.resize(size_t(entity.index) + 1);
+
+		// the slot is left by an entity of an older generation
+		if (m_slots[entity.index].id != InvalidEntityId && m_slots[entity.index].id != entity)
+			Remove(m_slots[entity.index].id);
+
+		Slot& slot = m_slots[entity.index];
+		slot.parent = (parent != entity && Contains(parent)) ? parent : InvalidEntityId;
+
+		// already stored
+		if (slot.id == entity) {
+			m_locals[slot.position] = &local;
+			m_ordered = false;
+			MarkDirty(entity);
+			return;
+		}
+
+		slot.id = entity;
+		slot.position = static_cast<std::uint32_t>(m_ids.size());
+
+		PushNode(entity, &local);
+	}
+	void TransformHierarchy::Remove(EntityId entity) {
+		if (!Contains(entity))
+			return;
+
+		// swap with the last node and pop, children are made roots by Reorder
+		Slot& slot = m_slots[entity.index];
+		const std::uint32_t position = slot.position;
+		const size_t last = m_ids.size() - 1;
+
+		if (position != last) {
+			m_ids[position] = m_ids[last];
+			m_locals[position] = m_locals[last];
+			m_dirty[position] = m_dirty[last];
+
+			m_world_00[position] = m_world_00[last];
+			m_world_10[position] = m_world_10[last];
+			m_world_20[position] = m_world_20[last];
+			m_world_01[position] = m_world_01[last];
+			m_world_11[position] = m_world_11[last];
+			m_world_21[position] = m_world_21[last];
+
+			m_slots[m_ids[position].index].position = position;
+		}
+
+		m_ids.pop_back();
+		m_locals.pop_back();
+		m_dirty.pop_back();
+
+		m_world_00.pop_back();
+		m_world_10.pop_back();
+		m_world_20.pop_back();
+		m_world_01.pop_back();
+		m_world_11.pop_back();
+		m_world_21.pop_back();
+
+		slot = Slot();
+		m_ordered = false;
+	}
+	void TransformHierarchy::Clear() {
+		m_slots.clear();
+
+		m_ids.clear();
+		m_parents.clear();
+		m_locals.clear();
+		m_dirty.clear();
+
+		m_world_00.clear();
+		m_world_10.clear();
+		m_world_20.clear();
+		m_world_01.clear();
+		m_world_11.clear();
+		m_world_21.clear();
+
+		m_level_ends.clear();
+		m_ordered = true;
+		m_first_dirty = NoNode;
+	}
+
+	bool TransformHierarchy::Contains(EntityId entity) const {
+		return FindSlot(entity) != nullptr;
+	}
+
+	void TransformHierarchy::SetParent(EntityId entity, EntityId parent) {
+		AE_ASSERT(Contains(entity), "Could not find entity in transform hierarchy");
+		AE_ASSERT(parent == InvalidEntityId || Contains(parent), "Could not find parent in transform hierarchy");
+		AE_ASSERT(parent == InvalidEntityId || !IsAncestor(entity, parent), "Could not set parent in transform hierarchy, it would create a cycle");
+
+		if (!Contains(entity) || (parent != InvalidEntityId && (!Contains(parent) || IsAncestor(entity, parent))))
+			return;
+
+		m_slots[entity.index].parent = parent;
+		m_ordered = false;
+
+		MarkDirty(entity);
+	}
+	EntityId TransformHierarchy::GetParent(EntityId entity) const {
+		const Slot* slot = FindSlot(entity);
+
+		// parent may have been removed
+		if (!slot || !Contains(slot->parent))
+			return InvalidEntityId;
+
+		return slot->parent;
+	}
+
+	void TransformHierarchy::MarkDirty(EntityId entity) {
+		const Slot* slot = FindSlot(entity);
+		if (!slot)
+			return;
+
+		m_dirty[slot->position] = 1;
+		m_first_dirty = std::min(m_first_dirty, size_t(slot->position));
+	}
+
+	Matrix3x3 TransformHierarchy::GetWorldMatrix(EntityId entity) const {
+		AE_ASSERT(Contains(entity), "Could not find entity in transform hierarchy");
+
+		const Slot* slot = FindSlot(entity);
+		if (!slot)
+			return Matrix3x3::Identity;
+
+		const std::uint32_t i = slot->position;
+
+		return Matrix3x3(
+			m_world_00[i], m_world_10[i], m_world_20[i],
+			m_world_01[i], m_world_11[i], m_world_21[i],
+			0.f, 0.f, 1.f
+		);
+	}
+	Vector2f TransformHierarchy::TransformPoint(EntityId entity, const Vector2f& point) const {
+		AE_ASSERT(Contains(entity), "Could not find entity in transform hierarchy");
+
+		const Slot* slot = FindSlot(entity);
+		if (!slot)
+			return point;
+
+		const std::uint32_t i = slot->position;
+
+		return Vector2f(
+			m_world_00[i] * point.x + m_world_10[i] * point.y + m_world_20[i],
+			m_world_01[i] * point.x + m_world_11[i] * point.y + m_world_21[i]
+		);
+	}
+
+	const TransformHierarchy::Slot* TransformHierarchy::FindSlot(EntityId entity) const {
+		if (entity.index >= m_slots.size() || m_slots[entity.index].id != entity)
+			return nullptr;
+
+		return &m_slots[entity.index];
+	}
+
+	bool TransformHierarchy::IsAncestor(EntityId ancestor, EntityId entity) const {
+		for (const Slot* slot = FindSlot(entity); slot; slot = FindSlot(slot->parent))
+			if (slot->id == ancestor)
+				return true;
+
+		return false;
+	}
+
+	void TransformHierarchy::PushNode(EntityId entity, const Transform2D* local) {
+		m_ids.push_back(entity);
+		m_locals.push_back(local);
+		m_dirty.push_back(1);
+
+		// identity until the first Update
+		m_world_00.push_back(1.f);
+		m_world_10.push_back(0.f);
+		m_world_20.push_back(0.f);
+		m_world_01.push_back(0.f);
+		m_world_11.push_back(1.f);
+		m_world_21.push_back(0.f);
+
+		m_ordered = false;
+	}
+
+//////// Update ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	void TransformHierarchy::Update(size_t grain) {
+		if (!m_ordered)
+			Reorder();
+
+		// nothing has changed
+		if (m_first_dirty == NoNode)
+			return;
+
+		// parents are processed a level before their children, nodes before the first dirty one cannot have dirty parents
+		for (size_t level = 0; level < m_level_ends.size(); level++) {
+
+			const size_t begin = std::max(size_t(level == 0 ? 0 : m_level_ends[level - 1]), m_first_dirty);
+			const size_t end = m_level_ends[level];
+
+			if (end <= begin)
+				continue;
+
+			if (end - begin > grain)
+				JobPool.ParallelFor(end - begin, grain, [this, begin](size_t chunk_begin, size_t chunk_end) {
+					UpdateRange(begin + chunk_begin, begin + chunk_end);
+				});
+			else
+				UpdateRange(begin, end);
+		}
+
+		std::fill(m_dirty.begin() + m_first_dirty, m_dirty.end(), std::uint8_t(0));
+		m_first_dirty = NoNode;
+	}
+
+	void TransformHierarchy::UpdateRange(size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const std::uint32_t parent = m_parents[i];
+
+			// dirtiness is inherited from the parent
+			if (parent != NoNode)
+				m_dirty[i] |= m_dirty[parent];
+
+			if (!m_dirty[i])
+				continue;
+
+			const Matrix3x3& local = m_locals[i]->GetMatrix();
+
+			const float l00 = local[0][0], l10 = local[1][0], l20 = local[2][0];
+			const float l01 = local[0][1], l11 = local[1][1], l21 = local[2][1];
+
+			// root
+			if (parent == NoNode) {
+				m_world_00[i] = l00; m_world_10[i] = l10; m_world_20[i] = l20;
+				m_world_01[i] = l01; m_world_11[i] = l11; m_world_21[i] = l21;
+				continue;
+			}
+
+			// parent's world matrix * local matrix
+			const float p00 = m_world_00[parent], p10 = m_world_10[parent], p20 = m_world_20[parent];
+			const float p01 = m_world_01[parent], p11 = m_world_11[parent], p21 = m_world_21[parent];
+
+			m_world_00[i] = p00 * l00 + p10 * l01;
+			m_world_10[i] = p00 * l10 + p10 * l11;
+			m_world_20[i] = p00 * l20 + p10 * l21 + p20;
+
+			m_world_01[i] = p01 * l00 + p11 * l01;
+			m_world_11[i] = p01 * l10 + p11 * l11;
+			m_world_21[i] = p01 * l20 + p11 * l21 + p21;
+		}
+	}
+
+	void TransformHierarchy::Reorder() {
+		const size_t count = m_ids.size();
+
+		// resolve parents' positions, children of removed nodes become roots
+		m_parents.resize(count);
+
+		for (size_t i = 0; i < count; i++) {
+			Slot& slot = m_slots[m_ids[i].index];
+			const Slot* parent = FindSlot(slot.parent);
+
+			if (!parent && slot.parent != InvalidEntityId) {
+				slot.parent = InvalidEntityId;
+				m_dirty[i] = 1;
+			}
+
+			m_parents[i] = parent ? parent->position : NoNode;
+		}
+
+		// depths, every chain of ancestors is walked once
+		std::vector<std::uint32_t> depths(count, NoNode);
+		std::vector<std::uint32_t> chain;
+		std::uint32_t max_depth = 0;
+
+		for (size_t i = 0; i < count; i++) {
+			std::uint32_t node = static_cast<std::uint32_t>(i);
+
+			while (depths[node] == NoNode && m_parents[node] != NoNode) {
+				chain.push_back(node);
+				node = m_parents[node];
+			}
+
+			std::uint32_t depth = (depths[node] == NoNode) ? 0 : depths[node];
+			depths[node] = depth;
+
+			while (!chain.empty()) {
+				depths[chain.back()] = ++depth;
+				chain.pop_back();
+			}
+
+			max_depth = std::max(max_depth, depth);
+		}
+
+		// counting sort by depth, keeps the relative order of nodes within a level
+		m_level_ends.assign(count ? max_depth + 1 : 0, 0);
+
+		for (size_t i = 0; i < count; i++)
+			m_level_ends[depths[i]]++;
+
+		std::uint32_t total = 0;
+		for (std::uint32_t& end : m_level_ends) {
+			total += end;
+			end = total;
+		}
+
+		std::vector<std::uint32_t> new_positions(count);
+		std::vector<std::uint32_t> next(m_level_ends.size(), 0);
+
+		for (size_t level = 1; level < next.size(); level++)
+			next[level] = m_level_ends[level - 1];
+
+		for (size_t i = 0; i < count; i++)
+			new_positions[i] = next[depths[i]]++;
+
+		// move every array into the new order
+		auto permute = [count, &new_positions](auto& elements) {
+			std::remove_reference_t<decltype(elements)> ordered(count);
+
+			for (size_t i = 0; i < count; i++)
+				ordered[new_positions[i]] = elements[i];
+
+			elements.swap(ordered);
+		};
+
+		for (std::uint32_t& parent : m_parents)
+			if (parent != NoNode)
+				parent = new_positions[parent];
+
+		permute(m_ids);
+		permute(m_parents);
+		permute(m_locals);
+		permute(m_dirty);
+
+		permute(m_world_00);
+		permute(m_world_10);
+		permute(m_world_20);
+		permute(m_world_01);
+		permute(m_world_11);
+		permute(m_world_21);
+
+		m_first_dirty = NoNode;
+
+		for (size_t i = 0; i < count; i++) {
+			m_slots[m_ids[i].index].position = static_cast<std::uint32_t>(i);
+
+			if (m_dirty[i] && m_first_dirty == NoNode)
+				m_first_dirty = i;
+		}
+
+		m_ordered = true;
+	}
+
+//////// TransformComponent ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	TransformComponent::~TransformComponent() {
+		if (m_id != InvalidEntityId)
+			m_hierarchy->Remove(m_id);
+	}
+
+	void TransformComponent::Initialize() {
+		m_id = GetEntity()->GetId();
+		m_hierarchy->Insert(m_id, m_local, m_parent);
+	}
+
+	Transform2D& TransformComponent::ModifyLocal() {
+		m_hierarchy->MarkDirty(m_id);
+		return m_local;
+	}
+
+	void TransformComponent::SetParent(EntityId parent) {
+		m_parent = parent;
+
+		if (m_id != InvalidEntityId)
+			m_hierarchy->SetParent(m_id, parent);
+	}
+	EntityId TransformComponent::GetParent() const {
+		return (m_id != InvalidEntityId) ? m_hierarchy->GetParent(m_id) : m_parent;
+	}
+
+	Matrix3x3 TransformComponent::GetWorldMatrix() const {
+		return m_hierarchy->GetWorldMatrix(m_id);
+	}
+	Vector2f TransformComponent::TransformPoint(const Vector2f& point) const {
+		return m_hierarchy->TransformPoint(m_id, point);
+	}
+}
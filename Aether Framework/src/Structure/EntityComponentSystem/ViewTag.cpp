@@ -35,33 +35,24 @@
 namespace ae {
 
 	namespace internal {
+		GroupTag::GroupTag(const std::set<EntityGroup>& include_groups, const std::set<EntityGroup>& exclude_groups) {
+			for (EntityGroup group : include_groups)
+				include.Set(group);
+
+			for (EntityGroup group : exclude_groups)
+				exclude.Set(group);
+		}
+
 		bool GroupTag::operator==(const GroupTag& other) const {
 			return (include == other.include && exclude == other.exclude);
 		}
 		bool GroupTag::operator!=(const GroupTag& other) const {
 			return !(include == other.include && exclude == other.exclude);
 		}
-		bool GroupTag::IsCompatible(const std::vector<EntityGroup>& groups) const {
-
-			for (EntityGroup incl_group : include)
-				if (std::find(groups.begin(), groups.end(), incl_group) == groups.end())
-					return false;
-
-			for (EntityGroup group : groups)
-				if (std::find(exclude.begin(), exclude.end(), group) != exclude.end())
-					return false;
-
-			return true;
-		}
 
 		size_t GroupTag::Hash::operator()(const GroupTag& tag) const {
-			size_t hash = 0;
-
-			for (EntityGroup group : tag.include)
-				hash ^= group + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-
-			for (EntityGroup group : tag.exclude)
-				hash ^= group + 0x9e3779b9 + (hash << 7) + (hash >> 3);
+			size_t hash = tag.include.Hash();
+			hash ^= tag.exclude.Hash() + 0x9e3779b9 + (hash << 7) + (hash >> 3);
 
 			return hash;
 		}
@@ -72,32 +63,12 @@ namespace ae {
 		bool ComponentTag::operator!=(const ComponentTag& other) const {
 			return !(include == other.include && exclude == other.exclude);
 		}
-		
-		bool ComponentTag::IsCompatible(const std::vector<Component*>& components) const {
-			for (const ComponentTypeId& incl_comp : include)
-
-				if (std::find_if(components.begin(), components.end(), 
-					[&incl_comp](Component* comp) {
-						return (ComponentTypeId(typeid(*comp)) == incl_comp);
-					}) == components.end())
-
-					return false;
-
-			for (const Component* component : components)
-				if (std::find(exclude.begin(), exclude.end(), typeid(*component)) != exclude.end())
-					return false;
-
-			return true;
-		}
 
 		size_t ComponentTag::Hash::operator()(const ComponentTag& tag) const {
-			size_t hash = 0;
-
-			for (const ComponentTypeId& component : tag.include)
-				hash ^= component.hash_code() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			std::hash<ComponentSignature> hasher;
 
-			for (const ComponentTypeId& component : tag.exclude)
-				hash ^= component.hash_code() + 0x9e3779b9 + (hash << 7) + (hash >> 3);
+			size_t hash = hasher(tag.include);
+			hash ^= hasher(tag.exclude) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
 
 			return hash;
 		}
@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+// 
+// Copyright (c) 2021, Wiktor Kasjaniuk
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include "Structure/JobPool.hpp"
+#include "Structure/Application.hpp"
+
+#include <algorithm>
+
+namespace ae {
+	internal::JobPoolType JobPool = internal::CreateStructure<internal::JobPoolType>();
+
+	namespace internal {
+
+		// index of the worker owning the current thread
+		static thread_local size_t t_worker_index = static_cast<size_t>(-1);
+
+		void JobPoolType::Start() {
+			if (m_started)
+				return;
+
+			std::lock_guard<std::mutex> lock(m_start_mutex);
+
+			if (m_started)
+				return;
+
+			size_t worker_count = g_framework_settings.job_pool_worker_count;
+
+			if (worker_count == 0) {
+				unsigned int hardware_threads = std::thread::hardware_concurrency();
+				worker_count = (hardware_threads > 1) ? hardware_threads - 1 : 0;
+			}
+
+			m_stop = false;
+
+			for (size_t i = 0; i < worker_count; i++)
+				m_workers.push_back(std::make_unique<Worker>());
+
+			for (size_t i = 0; i < worker_count; i++)
+				m_workers[i]->thread = std::thread(&JobPoolType::WorkerLoop, this, i);
+
+			m_started = true;
+		}
+		void JobPoolType::Terminate() {
+			std::lock_guard<std::mutex> lock(m_start_mutex);
+
+			if (!m_started)
+				return;
+
+			// wake up and join
+			{
+				std::lock_guard<std::mutex> sleep_lock(m_sleep_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+
+			for (std::unique_ptr<Worker>& worker : m_workers)
+				worker->thread.join();
+
+			m_workers.clear();
+			m_started = false;
+		}
+
+		size_t JobPoolType::GetThreadCount() {
+			Start();
+			return m_workers.size() + 1;
+		}
+		bool JobPoolType::IsWorkerThread() const {
+			return t_worker_index != static_cast<size_t>(-1);
+		}
+
+//////// Jobs ////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		void JobPoolType::WorkerLoop(size_t index) {
+			t_worker_index = index;
+
+			while (true) {
+				Job job;
+
+				if (PopJob(index, job)) {
+					Execute(job);
+					continue;
+				}
+
+				// sleep until there are jobs to take
+				std::unique_lock<std::mutex> lock(m_sleep_mutex);
+				m_wake.wait(lock, [this]() { return m_stop || m_queued_jobs > 0; });
+
+				if (m_stop)
+					return;
+			}
+		}
+
+		bool JobPoolType::PopJob(size_t first_queue, Job& job) {
+			if (m_queued_jobs == 0)
+				return false;
+
+			for (size_t i = 0; i < m_workers.size(); i++) {
+				size_t queue = (first_queue + i) % m_workers.size();
+				Worker& worker = *m_workers[queue];
+
+				std::lock_guard<std::mutex> lock(worker.mutex);
+
+				if (worker.jobs.empty())
+					continue;
+
+				// own queue - take from the front, steal from the back
+				if (i == 0 && queue == t_worker_index) {
+					job = worker.jobs.front();
+					worker.jobs.pop_front();
+				}
+				else {
+					job = worker.jobs.back();
+					worker.jobs.pop_back();
+				}
+
+				m_queued_jobs--;
+				return true;
+			}
+			return false;
+		}
+
+		void JobPoolType::Execute(const Job& job) {
+			Batch& batch = *job.batch;
+
+			try {
+				(*batch.operation)(job.begin, job.end);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(batch.error_mutex);
+
+				if (!batch.error)
+					batch.error = std::current_exception();
+			}
+
+			// batch may be destroyed by its caller once the last job is counted
+			batch.remaining.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		void JobPoolType::ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& operation) {
+			if (count == 0)
+				return;
+
+			if (grain == 0)
+				grain = 1;
+
+			Start();
+
+			size_t chunk_count = (count + grain - 1) / grain;
+
+			// nothing to share
+			if (chunk_count == 1 || m_workers.empty()) {
+				for (size_t begin = 0; begin < count; begin += grain)
+					operation(begin, std::min(begin + grain, count));
+				return;
+			}
+
+			// distribute chunks between workers
+			Batch batch;
+			batch.operation = &operation;
+			batch.remaining = chunk_count;
+
+			size_t first_queue = IsWorkerThread() ? t_worker_index : m_next_worker++ % m_workers.size();
+
+			for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+				Job job;
+				job.batch = &batch;
+				job.begin = chunk * grain;
+				job.end = std::min(job.begin + grain, count);
+
+				Worker& worker = *m_workers[(first_queue + chunk) % m_workers.size()];
+
+				std::lock_guard<std::mutex> lock(worker.mutex);
+				worker.jobs.push_back(job);
+				m_queued_jobs++;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+			}
+			m_wake.notify_all();
+
+			// help until all chunks are done
+			while (batch.remaining.load(std::memory_order_acquire) > 0) {
+				Job job;
+
+				if (PopJob(IsWorkerThread() ? t_worker_index : first_queue, job))
+					Execute(job);
+				else
+					std::this_thread::yield();
+			}
+
+			// no job refers to the batch anymore
+			if (batch.error)
+				std::rethrow_exception(batch.error);
+		}
+
+		void JobPoolType::Run(const std::vector<std::function<void()>>& jobs) {
+			ParallelFor(jobs.size(), 1, [&jobs](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					jobs[i]();
+			});
+		}
+	}
+}